@@ -0,0 +1,26 @@
+/**
+ * Replay driver for compilers without libFuzzer (e.g. GCC)
+ * Runs LLVMFuzzerTestOneInput once per file named on the command line, so a saved corpus can be
+ * replayed as a regression test under the sanitizers.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+int main(int argc, char** argv) {
+    for (int index = 1; index < argc; ++index) {
+        std::ifstream file(argv[index], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "cannot read %s\n", argv[index]);
+            return 1;
+        }
+        const std::vector<char> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(input.data()), input.size());
+    }
+    std::printf("%d inputs replayed\n", argc - 1);
+    return 0;
+}
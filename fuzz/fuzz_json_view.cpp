@@ -0,0 +1,55 @@
+/**
+ * Fuzz target: JsonParser / JsonValue
+ * Indexes the input and walks every value of accepted documents.
+ */
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstdlib>
+#include "JsonView.h"
+
+namespace {
+
+    Void Walk(const JsonValue& value, UInt depth) {
+        if (depth > 64) return;
+        value.GetRawJson();
+        switch (value.GetType()) {
+            case JsonType::Object:
+                value.ForEachField([depth](std::string_view key, const JsonValue& member) {
+                    member.IsValid();
+                    Walk(member, depth + 1);
+                    (void)key;
+                });
+                break;
+            case JsonType::Array:
+                value.ForEachElement([depth](const JsonValue& element) { Walk(element, depth + 1); });
+                value[value.GetSize()];
+                break;
+            case JsonType::String:
+                value.GetString();
+                break;
+            case JsonType::Number:
+                value.GetInt64();
+                value.GetDouble();
+                break;
+            case JsonType::Boolean:
+                value.GetBool();
+                break;
+            case JsonType::Null:
+                break;
+            case JsonType::Invalid:
+                std::abort();
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    // Heap copy of exactly size bytes so ASan catches reads past the end
+    StdVector<char> json(reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + size);
+    JsonParser parser;
+    const JsonValue root = parser.Index(std::string_view(json.data(), json.size()));
+    if (root.IsValid()) {
+        Walk(root, 0);
+        root["key"];
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+/**
+ * Fuzz target: HttpRequestHeadGuard
+ * The first input byte picks a split point; the verdict and head length must not depend on how
+ * the bytes arrive. Accepted heads must also agree with SimpleHttpRequest on Content-Length.
+ */
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstdlib>
+#include "IHttpRequest.h"
+#include "HttpRequestHeadGuard.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    if (size == 0) return 0;
+    const Size split = data[0] % size;
+    const char* bytes = reinterpret_cast<const char*>(data + 1);
+    const Size length = size - 1;
+    HttpLimitCounters counters;
+
+    HttpRequestHeadGuard whole(HttpRequestLimits(), &counters);
+    const HttpHeadStatus wholeStatus = whole.Feed(bytes, length);
+
+    HttpRequestHeadGuard pieces(HttpRequestLimits(), &counters);
+    const Size first = split < length ? split : length;
+    HttpHeadStatus pieceStatus = pieces.Feed(bytes, first);
+    if (pieceStatus == HttpHeadStatus::NeedMore) pieceStatus = pieces.Feed(bytes + first, length - first);
+
+    if (wholeStatus != pieceStatus) std::abort();
+    if (wholeStatus == HttpHeadStatus::Complete) {
+        if (whole.GetHeadLength() != pieces.GetHeadLength() || whole.GetHeadLength() > length) std::abort();
+        if (whole.HasContentLength() && !whole.IsChunked()) {
+            IHttpRequestPtr request = IHttpRequest::GetRequest("fuzz", StdString(bytes, whole.GetHeadLength()));
+            if (request->GetContentLength() != whole.GetContentLength()) std::abort();
+        }
+    } else if (wholeStatus != HttpHeadStatus::NeedMore) {
+        if (whole.MakeRejectResponse("fuzz") == nullptr) std::abort();
+    }
+    return 0;
+}
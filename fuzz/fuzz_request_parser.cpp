@@ -0,0 +1,187 @@
+/**
+ * Fuzz target: SimpleHttpRequest and HttpRequestHeadGuard against llhttp
+ * Whenever the guard accepts a head that llhttp also parses up to the end of its headers, both of
+ * our parsers must agree with llhttp on method, target, version, header values and body framing
+ * (Content-Length / chunked). Inputs only one side accepts are not reported: the guard is
+ * deliberately stricter than llhttp on limits and whitespace. Every accessor, including the JSON
+ * body view, is then touched for the sanitizers.
+ */
+#include <StandardDefines.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <llhttp.h>
+#include "IHttpRequest.h"
+#include "HttpMethod.h"
+#include "HttpRequestHeadGuard.h"
+
+namespace {
+
+    /**
+     * What llhttp saw up to on_headers_complete
+     */
+    struct ReferenceHead {
+        StdString target;
+        StdVector<std::pair<StdString, StdString>> headers;
+        Bool readingField = false;
+        Bool headersComplete = false;
+        Bool chunked = false;
+        Bool hasContentLength = false;
+        ULong contentLength = 0;
+        StdString method;
+        StdString version;
+    };
+
+    ReferenceHead& HeadOf(llhttp_t* parser) {
+        return *static_cast<ReferenceHead*>(parser->data);
+    }
+
+    int OnUrl(llhttp_t* parser, const char* at, std::size_t length) {
+        HeadOf(parser).target.append(at, length);
+        return 0;
+    }
+
+    int OnHeaderField(llhttp_t* parser, const char* at, std::size_t length) {
+        ReferenceHead& head = HeadOf(parser);
+        // The first piece of a name starts the next header; names and values may arrive in pieces
+        if (!head.readingField) {
+            head.headers.emplace_back();
+            head.readingField = true;
+        }
+        head.headers.back().first.append(at, length);
+        return 0;
+    }
+
+    int OnHeaderFieldComplete(llhttp_t* parser) {
+        HeadOf(parser).readingField = false;
+        return 0;
+    }
+
+    int OnHeaderValue(llhttp_t* parser, const char* at, std::size_t length) {
+        HeadOf(parser).headers.back().second.append(at, length);
+        return 0;
+    }
+
+    int OnHeadersComplete(llhttp_t* parser) {
+        ReferenceHead& head = HeadOf(parser);
+        head.headersComplete = true;
+        head.chunked = (parser->flags & F_CHUNKED) != 0;
+        head.hasContentLength = (parser->flags & F_CONTENT_LENGTH) != 0;
+        head.contentLength = static_cast<ULong>(parser->content_length);
+        head.method = llhttp_method_name(static_cast<llhttp_method_t>(llhttp_get_method(parser)));
+        head.version = "HTTP/" + std::to_string(llhttp_get_http_major(parser)) + "." +
+                       std::to_string(llhttp_get_http_minor(parser));
+        // Stop here: the body is framed by the guard's verdict, not parsed
+        return HPE_PAUSED;
+    }
+
+    StdString Lower(StdString value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return value;
+    }
+
+    StdString Trim(CStdString& value) {
+        const Size first = value.find_first_not_of(" \t");
+        if (first == StdString::npos) return "";
+        return value.substr(first, value.find_last_not_of(" \t") - first + 1);
+    }
+
+    Bool IsKnownMethod(CStdString& name) {
+        static const char* const kMethods[] = {"GET", "POST", "PUT", "DELETE", "PATCH",
+                                               "HEAD", "OPTIONS", "TRACE", "CONNECT"};
+        for (const char* method : kMethods) {
+            if (name == method) return true;
+        }
+        return false;
+    }
+
+    [[noreturn]] Void Mismatch(const char* field, CStdString& expected, CStdString& actual) {
+        std::fprintf(stderr, "%s differs from llhttp: expected \"%s\", got \"%s\"\n",
+                     field, expected.c_str(), actual.c_str());
+        std::abort();
+    }
+
+    Void CompareWithReference(const ReferenceHead& reference, const IHttpRequest& request,
+                              const HttpRequestHeadGuard& guard) {
+        // SimpleHttpRequest maps methods it does not know to GET, so only known names are compared
+        if (IsKnownMethod(reference.method) && MethodToString(request.GetMethod()) != reference.method) {
+            Mismatch("method", reference.method, MethodToString(request.GetMethod()));
+        }
+        if (request.GetFullUrl() != reference.target) Mismatch("target", reference.target, request.GetFullUrl());
+        if (request.GetHttpVersion() != reference.version) {
+            Mismatch("version", reference.version, request.GetHttpVersion());
+        }
+
+        // Repeated names are combined differently by each parser, so only single headers are compared
+        StdMap<StdString, Size> occurrences;
+        for (const auto& header : reference.headers) ++occurrences[Lower(header.first)];
+        for (const auto& header : reference.headers) {
+            if (occurrences[Lower(header.first)] != 1) continue;
+            const StdString expected = Trim(header.second);
+            const StdString actual = request.GetHeader(header.first);
+            if (actual != expected) Mismatch(("header " + header.first).c_str(), expected, actual);
+        }
+
+        if (guard.IsChunked() != reference.chunked) {
+            Mismatch("chunked", reference.chunked ? "true" : "false", guard.IsChunked() ? "true" : "false");
+        }
+        if (!reference.chunked) {
+            if (guard.HasContentLength() != reference.hasContentLength) {
+                Mismatch("Content-Length presence", reference.hasContentLength ? "true" : "false",
+                         guard.HasContentLength() ? "true" : "false");
+            }
+            if (reference.hasContentLength && guard.GetContentLength() != reference.contentLength) {
+                Mismatch("Content-Length", std::to_string(reference.contentLength),
+                         std::to_string(guard.GetContentLength()));
+            }
+        }
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    HttpLimitCounters counters;
+    HttpRequestHeadGuard guard(HttpRequestLimits(), &counters);
+    const HttpHeadStatus status = guard.Feed(bytes, size);
+
+    if (status == HttpHeadStatus::Complete) {
+        llhttp_settings_t settings;
+        llhttp_settings_init(&settings);
+        settings.on_url = OnUrl;
+        settings.on_header_field = OnHeaderField;
+        settings.on_header_field_complete = OnHeaderFieldComplete;
+        settings.on_header_value = OnHeaderValue;
+        settings.on_headers_complete = OnHeadersComplete;
+        ReferenceHead reference;
+        llhttp_t parser;
+        llhttp_init(&parser, HTTP_REQUEST, &settings);
+        parser.data = &reference;
+        llhttp_execute(&parser, bytes, guard.GetHeadLength());
+
+        if (reference.headersComplete) {
+            IHttpRequestPtr request = IHttpRequest::GetRequest("fuzz", StdString(bytes, guard.GetHeadLength()));
+            if (request == nullptr) std::abort();
+            CompareWithReference(reference, *request, guard);
+        }
+    }
+
+    // Smoke check over the whole input, accepted by the guard or not
+    IHttpRequestPtr request = IHttpRequest::GetRequest("fuzz", StdString(bytes, size));
+    if (request == nullptr) return 0;  // GetRequest() returns nullptr for empty input
+    request->GetCookie("session");
+    request->GetQueryParameter("q");
+    request->GetBasicAuthCredentials();
+    request->GetApiKey();
+    request->GetClientAddress();
+    request->GetBodyBytes();
+    const JsonValue json = request->GetJson();
+    if (json.IsValid()) {
+        json.ForEachField([](std::string_view, const JsonValue& value) { value.GetRawJson(); value.GetString(); });
+        json.ForEachElement([](const JsonValue& value) { value.GetDouble(); value.GetInt64(); });
+    }
+    return 0;
+}
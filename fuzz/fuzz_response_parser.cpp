@@ -0,0 +1,54 @@
+/**
+ * Fuzz target: HttpResponseParser, including the chunked body decoder
+ * The first input byte picks a feed size; parsing the stream in pieces must produce the same
+ * responses as parsing it at once. Pipelined responses are taken until the stream runs out.
+ */
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstdlib>
+#include "IHttpResponse.h"
+#include "HttpResponseParser.h"
+
+namespace {
+
+    /**
+     * Status code and body of every complete response, with the final status
+     */
+    StdVector<StdString> ParseAll(const char* data, Size length, Size step, Bool noBody) {
+        StdVector<StdString> results;
+        HttpResponseParser parser(true);
+        parser.ExpectNoBody(noBody);
+        HttpResponseParseStatus status = HttpResponseParseStatus::NeedMore;
+        Size offset = 0;
+        for (;;) {
+            while (status == HttpResponseParseStatus::NeedMore && offset < length) {
+                const Size count = step < length - offset ? step : length - offset;
+                status = parser.Feed(data + offset, count);
+                offset += count;
+            }
+            if (status == HttpResponseParseStatus::NeedMore) status = parser.Finish();
+            if (status != HttpResponseParseStatus::Complete) break;
+            parser.GetHeader("content-type");
+            parser.IsKeepAlive();
+            IHttpResponsePtr response = parser.TakeResponse("fuzz");
+            if (response == nullptr) std::abort();
+            results.push_back(std::to_string(response->GetStatusCode()) + " " + response->GetBody());
+            response->ToHttpString();
+            // Stop at a clean end of stream; otherwise parse the next (pipelined) response
+            if (offset >= length && !parser.HasBufferedData()) break;
+            parser.ExpectNoBody(noBody);
+            status = parser.Parse();
+        }
+        results.push_back(status == HttpResponseParseStatus::Error ? "error" : "end");
+        return results;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    if (size == 0) return 0;
+    const Size step = data[0] % 64 + 1;
+    const Bool noBody = (data[0] & 0x80) != 0;
+    const char* bytes = reinterpret_cast<const char*>(data + 1);
+    if (ParseAll(bytes, size - 1, size, noBody) != ParseAll(bytes, size - 1, step, noBody)) std::abort();
+    return 0;
+}
@@ -0,0 +1,481 @@
+#ifndef ASSETBUNDLE_H
+#define ASSETBUNDLE_H
+
+#include <StandardDefines.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "FastHash.h"
+#include "HttpMethod.h"
+#include "HttpResponseParser.h"
+#include "IHttpRequest.h"
+#include "IHttpResponse.h"
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#ifdef SERVERLIB_LINUX
+#include <sys/sendfile.h>
+#endif
+
+/**
+ * On-disk layout of a bundle written by serverlib_scripts/pack_assets.py (keep both in sync)
+ * All integers are little-endian; offsets are from the start of the file.
+ *
+ *   FileHeader
+ *   int32 displacement[bucketCount]          perfect-hash displacements, padded to 8 bytes
+ *   Entry entries[assetCount]                indexed by perfect-hash slot
+ *   paths, then per variant: 200 head + 304 head (each ending with the blank line)
+ *   bodies, 8-byte aligned
+ *
+ * Lookup: bucket = Hash64(path) % bucketCount, d = displacement[bucket];
+ * slot = d < 0 ? -d - 1 : Hash64(path, d) % assetCount. The slot's path must still be compared.
+ */
+namespace AssetBundleFormat {
+
+    static constexpr char kFileMagic[8] = { 'S', 'L', 'A', 'S', 'S', 'E', 'T', '1' };
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kGzipFlag = 1;
+
+    class FileHeader {
+        Public char magic[8];
+        Public std::uint32_t version;
+        Public std::uint32_t headerSize;
+        Public std::uint32_t assetCount;
+        Public std::uint32_t bucketCount;
+        Public std::uint64_t bucketOffset;
+        Public std::uint64_t entryOffset;
+        Public std::uint64_t fileSize;
+        Public std::uint64_t reserved[2];
+    };
+
+    /**
+     * One representation of an asset; the 304 head immediately follows the 200 head
+     */
+    class Variant {
+        Public std::uint64_t headOffset;
+        Public std::uint32_t headLength;
+        Public std::uint32_t notModifiedLength;
+        Public std::uint64_t bodyOffset;
+        Public std::uint64_t bodyLength;
+        // ETag value (with quotes) inside the 200 head
+        Public std::uint32_t etagOffset;
+        Public std::uint32_t etagLength;
+    };
+
+    class Entry {
+        Public std::uint64_t pathOffset;
+        Public std::uint32_t pathLength;
+        Public std::uint32_t flags;
+        // [0] identity, [1] gzip (valid when flags has kGzipFlag)
+        Public Variant variants[2];
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "AssetBundleFormat::FileHeader layout");
+    static_assert(sizeof(Entry) == 96, "AssetBundleFormat::Entry layout");
+}
+
+/**
+ * What to send for one request: both views point into the bundle
+ */
+class AssetView {
+    // Status line and headers including the terminating blank line; to append headers
+    // (e.g. Connection: close), send head minus its last two bytes, the headers, then "\r\n"
+    Public std::string_view head;
+    // Empty for 304 responses and HEAD requests
+    Public std::string_view body;
+    Public std::uint64_t bodyOffset = 0;
+    Public Bool gzip = false;
+    Public Bool notModified = false;
+};
+
+/**
+ * Static assets served from a bundle built by serverlib_scripts/pack_assets.py
+ * The bundle is memory-mapped (Open) or used in place from flash/ROM (Attach, with the array from
+ * pack_assets.py --c-header). Each asset carries pre-serialized response heads with Content-Type,
+ * Content-Length, ETag and Cache-Control, and an optional precompressed gzip variant, so serving a
+ * request is a perfect-hash lookup and two writes: no header formatting and no body copy.
+ * Read-only after Open/Attach; lookups are thread-safe.
+ *
+ *   AssetBundle assets;
+ *   assets.Open("/data/www.bin");
+ *   AssetView view;
+ *   if (assets.Select(*request, view)) assets.Send(clientFd, view);    // or as a middleware stage
+ */
+class AssetBundle {
+
+    /**
+     * Bodies from this size are sent with sendfile() when the bundle is file-backed
+     */
+    Public Static constexpr Size kSendfileThreshold = 16 * 1024;
+
+    Private const char* data_;
+    Private Size size_;
+    Private Bool mapped_;
+    Private int fd_;
+    Private AssetBundleFormat::FileHeader header_;
+    Private const std::int32_t* displacements_;
+    Private const AssetBundleFormat::Entry* entries_;
+
+    Private Static Bool EqualsIgnoreCase(std::string_view value, std::string_view lowerLiteral) {
+        if (value.length() != lowerLiteral.length()) return false;
+        for (Size index = 0; index < value.length(); ++index) {
+            char c = value[index];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if (c != lowerLiteral[index]) return false;
+        }
+        return true;
+    }
+
+    Private Static std::string_view Trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+        return value;
+    }
+
+    /**
+     * Call fn(item) for each comma-separated, trimmed, non-empty item; stops when fn returns true
+     */
+    template<typename Fn>
+    Static Bool AnyListItem(std::string_view list, Fn&& fn) {
+        while (!list.empty()) {
+            const Size comma = list.find(',');
+            const std::string_view item = Trim(list.substr(0, comma));
+            if (!item.empty() && fn(item)) return true;
+            if (comma == std::string_view::npos) break;
+            list.remove_prefix(comma + 1);
+        }
+        return false;
+    }
+
+    /**
+     * True if Accept-Encoding lists gzip (or *) without q=0
+     */
+    Private Static Bool AcceptsGzip(std::string_view acceptEncoding) {
+        return AnyListItem(acceptEncoding, [](std::string_view item) {
+            const Size semicolon = item.find(';');
+            const std::string_view coding = Trim(item.substr(0, semicolon));
+            if (!EqualsIgnoreCase(coding, "gzip") && coding != "*") return false;
+            if (semicolon == std::string_view::npos) return true;
+            std::string_view parameter = Trim(item.substr(semicolon + 1));
+            if (parameter.length() < 2 || (parameter[0] != 'q' && parameter[0] != 'Q') || parameter[1] != '=') return true;
+            parameter.remove_prefix(2);
+            // q=0, q=0.0, q=0.000 reject the coding
+            if (parameter.empty() || parameter[0] != '0') return true;
+            for (Size index = 1; index < parameter.length(); ++index) {
+                if (parameter[index] != '.' && parameter[index] != '0') return true;
+            }
+            return false;
+        });
+    }
+
+    /**
+     * If-None-Match uses the weak comparison: W/ prefixes are ignored
+     */
+    Private Static Bool MatchesETag(std::string_view ifNoneMatch, std::string_view etag) {
+        return AnyListItem(ifNoneMatch, [etag](std::string_view item) {
+            if (item == "*") return true;
+            if (item.length() > 2 && item[0] == 'W' && item[1] == '/') item.remove_prefix(2);
+            return item == etag;
+        });
+    }
+
+    Private std::string_view Slice(std::uint64_t offset, std::uint64_t length) const {
+        return std::string_view(data_ + offset, static_cast<Size>(length));
+    }
+
+    Private Bool ValidRange(std::uint64_t offset, std::uint64_t length) const {
+        return offset <= size_ && length <= size_ - offset;
+    }
+
+    /**
+     * Check every offset once so lookups need no bounds checks
+     */
+    Private Bool Validate() {
+        if (size_ < sizeof(header_)) return false;
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (std::memcmp(header_.magic, AssetBundleFormat::kFileMagic, sizeof(header_.magic)) != 0 ||
+            header_.version != AssetBundleFormat::kVersion || header_.headerSize != sizeof(header_) ||
+            header_.fileSize > size_ || header_.bucketCount == 0 ||
+            header_.bucketOffset % alignof(std::int32_t) != 0 || header_.entryOffset % alignof(AssetBundleFormat::Entry) != 0 ||
+            reinterpret_cast<std::uintptr_t>(data_) % alignof(AssetBundleFormat::Entry) != 0 ||
+            !ValidRange(header_.bucketOffset, static_cast<std::uint64_t>(header_.bucketCount) * sizeof(std::int32_t)) ||
+            !ValidRange(header_.entryOffset, static_cast<std::uint64_t>(header_.assetCount) * sizeof(AssetBundleFormat::Entry))) {
+            return false;
+        }
+        displacements_ = reinterpret_cast<const std::int32_t*>(data_ + header_.bucketOffset);
+        entries_ = reinterpret_cast<const AssetBundleFormat::Entry*>(data_ + header_.entryOffset);
+        for (std::uint32_t bucket = 0; bucket < header_.bucketCount; ++bucket) {
+            const std::int32_t displacement = displacements_[bucket];
+            if (displacement < 0 && static_cast<std::uint32_t>(-(displacement + 1)) >= header_.assetCount) return false;
+        }
+        for (std::uint32_t slot = 0; slot < header_.assetCount; ++slot) {
+            const AssetBundleFormat::Entry& entry = entries_[slot];
+            if (!ValidRange(entry.pathOffset, entry.pathLength)) return false;
+            const UInt variants = (entry.flags & AssetBundleFormat::kGzipFlag) != 0 ? 2 : 1;
+            for (UInt index = 0; index < variants; ++index) {
+                const AssetBundleFormat::Variant& variant = entry.variants[index];
+                if (!ValidRange(variant.headOffset, static_cast<std::uint64_t>(variant.headLength) + variant.notModifiedLength) ||
+                    !ValidRange(variant.bodyOffset, variant.bodyLength) ||
+                    static_cast<std::uint64_t>(variant.etagOffset) + variant.etagLength > variant.headLength) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    Private const AssetBundleFormat::Entry* FindEntry(std::string_view path) const {
+        if (data_ == nullptr || header_.assetCount == 0) return nullptr;
+        const Size query = path.find('?');
+        if (query != std::string_view::npos) path = path.substr(0, query);
+        const std::int32_t displacement = displacements_[FastHash::Hash64(path) % header_.bucketCount];
+        const std::uint64_t slot = displacement < 0
+            ? static_cast<std::uint64_t>(-(static_cast<std::int64_t>(displacement) + 1))
+            : FastHash::Hash64(path, static_cast<std::uint64_t>(displacement)) % header_.assetCount;
+        const AssetBundleFormat::Entry& entry = entries_[slot];
+        return Slice(entry.pathOffset, entry.pathLength) == path ? &entry : nullptr;
+    }
+
+    Private Static Bool WaitWritable(int fd, std::chrono::steady_clock::time_point deadline) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) return false;
+        pollfd entry{ fd, POLLOUT, 0 };
+        return ::poll(&entry, 1, static_cast<int>(remaining)) == 1;
+#else
+        (void)fd; (void)deadline;
+        return false;
+#endif
+    }
+
+    Public AssetBundle()
+        : data_(nullptr), size_(0), mapped_(false), fd_(-1), header_(), displacements_(nullptr), entries_(nullptr) {}
+
+    AssetBundle(const AssetBundle&) = delete;
+    AssetBundle& operator=(const AssetBundle&) = delete;
+
+    Public ~AssetBundle() {
+        Close();
+    }
+
+    /**
+     * Map a bundle file read-only
+     * @return false if the file cannot be mapped or is not a valid bundle
+     */
+    Public Bool Open(CStdString& path) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        Close();
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) return false;
+        struct stat info;
+        if (::fstat(fd_, &info) != 0 || info.st_size <= 0) {
+            Close();
+            return false;
+        }
+        void* map = ::mmap(nullptr, static_cast<Size>(info.st_size), PROT_READ, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            Close();
+            return false;
+        }
+        data_ = static_cast<const char*>(map);
+        size_ = static_cast<Size>(info.st_size);
+        mapped_ = true;
+        // The index and heads are touched on every request; bring them in up front
+        ::madvise(map, size_, MADV_WILLNEED);
+        if (!Validate()) {
+            Close();
+            return false;
+        }
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    /**
+     * Use a bundle already in memory (e.g. the array from pack_assets.py --c-header)
+     * @param data 8-byte aligned; must outlive the AssetBundle
+     */
+    Public Bool Attach(const void* data, Size size) {
+        Close();
+        data_ = static_cast<const char*>(data);
+        size_ = size;
+        if (data_ == nullptr || !Validate()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    Public Void Close() {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (mapped_) ::munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+        fd_ = -1;
+        header_ = AssetBundleFormat::FileHeader();
+        displacements_ = nullptr;
+        entries_ = nullptr;
+    }
+
+    Public Bool IsOpen() const {
+        return data_ != nullptr;
+    }
+
+    /**
+     * Number of indexed paths (a directory's index.html is indexed under both paths)
+     */
+    Public UInt GetPathCount() const {
+        return header_.assetCount;
+    }
+
+    Public Bool Contains(std::string_view path) const {
+        return FindEntry(path) != nullptr;
+    }
+
+    /**
+     * Pick the representation and response head for a request
+     * @param path Request path; a query string is ignored
+     * @param acceptEncoding Accept-Encoding header ("" if absent)
+     * @param ifNoneMatch If-None-Match header ("" if absent); a match selects the 304 head
+     * @param headRequest Leave the body out
+     * @return false if the path is not in the bundle
+     */
+    Public Bool Select(std::string_view path, std::string_view acceptEncoding, std::string_view ifNoneMatch,
+                       Bool headRequest, AssetView& view) const {
+        const AssetBundleFormat::Entry* entry = FindEntry(path);
+        if (entry == nullptr) return false;
+        view.gzip = (entry->flags & AssetBundleFormat::kGzipFlag) != 0 && !acceptEncoding.empty() && AcceptsGzip(acceptEncoding);
+        const AssetBundleFormat::Variant& variant = entry->variants[view.gzip ? 1 : 0];
+        const std::string_view head = Slice(variant.headOffset, variant.headLength);
+        view.notModified = !ifNoneMatch.empty() && MatchesETag(ifNoneMatch, head.substr(variant.etagOffset, variant.etagLength));
+        if (view.notModified) {
+            view.head = Slice(variant.headOffset + variant.headLength, variant.notModifiedLength);
+            view.body = std::string_view();
+            view.bodyOffset = 0;
+            return true;
+        }
+        view.head = head;
+        view.body = headRequest ? std::string_view() : Slice(variant.bodyOffset, variant.bodyLength);
+        view.bodyOffset = variant.bodyOffset;
+        return true;
+    }
+
+    /**
+     * Select() for a parsed request; only GET and HEAD are served from the bundle
+     */
+    Public Bool Select(const IHttpRequest& request, AssetView& view) const {
+        const HttpMethod method = request.GetMethod();
+        if (method != HttpMethod::GET && method != HttpMethod::HEAD) return false;
+        return Select(request.GetPath(), request.GetHeader("Accept-Encoding"), request.GetHeader("If-None-Match"),
+                      method == HttpMethod::HEAD, view);
+    }
+
+    /**
+     * Write the head and body to a client socket (blocking or non-blocking)
+     * File-backed bundles send large bodies with sendfile(); otherwise head and body go out in one writev().
+     * @return true if the whole response was sent before the timeout
+     */
+    Public Bool Send(int fd, const AssetView& view, int timeoutMs = 30000) const {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        Size headSent = 0;
+        Size bodySent = 0;
+#ifdef SERVERLIB_LINUX
+        const Bool useSendfile = fd_ >= 0 && view.body.length() >= kSendfileThreshold;
+#else
+        const Bool useSendfile = false;
+#endif
+        while (headSent < view.head.length() || bodySent < view.body.length()) {
+            ssize_t count = 0;
+            if (useSendfile && headSent == view.head.length()) {
+#ifdef SERVERLIB_LINUX
+                off_t offset = static_cast<off_t>(view.bodyOffset + bodySent);
+                count = ::sendfile(fd, fd_, &offset, view.body.length() - bodySent);
+                if (count > 0) bodySent += static_cast<Size>(count);
+#endif
+            } else {
+                iovec parts[2];
+                int partCount = 0;
+                if (headSent < view.head.length()) {
+                    parts[partCount].iov_base = const_cast<char*>(view.head.data() + headSent);
+                    parts[partCount++].iov_len = view.head.length() - headSent;
+                }
+                if (!useSendfile && bodySent < view.body.length()) {
+                    parts[partCount].iov_base = const_cast<char*>(view.body.data() + bodySent);
+                    parts[partCount++].iov_len = view.body.length() - bodySent;
+                }
+                msghdr message{};
+                message.msg_iov = parts;
+                message.msg_iovlen = partCount;
+                int flags = 0;
+#ifdef MSG_NOSIGNAL
+                flags |= MSG_NOSIGNAL;
+#endif
+#ifdef MSG_MORE
+                // The head alone is followed by sendfile(): let the kernel coalesce them
+                if (useSendfile) flags |= MSG_MORE;
+#endif
+                count = ::sendmsg(fd, &message, flags);
+                if (count > 0) {
+                    Size written = static_cast<Size>(count);
+                    const Size headPart = std::min(written, view.head.length() - headSent);
+                    headSent += headPart;
+                    bodySent += written - headPart;
+                }
+            }
+            if (count > 0) continue;
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!WaitWritable(fd, deadline)) return false;
+                continue;
+            }
+            return false;
+        }
+        return true;
+#else
+        (void)fd; (void)view; (void)timeoutMs;
+        return false;
+#endif
+    }
+
+    /**
+     * Build an IHttpResponse from a selection, for servers that write responses themselves
+     * The head is parsed and the body copied once; Send() avoids both.
+     */
+    Public IHttpResponsePtr ToResponse(CStdString& requestId, const AssetView& view) const {
+        HttpResponseParser parser(false);
+        parser.ExpectNoBody(view.body.empty());
+        parser.Feed(view.head.data(), view.head.length());
+        if (parser.Feed(view.body.data(), view.body.length()) != HttpResponseParseStatus::Complete) return nullptr;
+        return parser.TakeResponse(requestId);
+    }
+
+    /**
+     * Middleware stage: answer GET/HEAD requests for bundled paths, pass the rest down the chain
+     */
+    template<typename Next>
+    IHttpResponsePtr Handle(const IHttpRequestPtr& request, Next&& next) {
+        AssetView view;
+        if (!Select(*request, view)) return next(request);
+        IHttpResponsePtr response = ToResponse(request->GetRequestId(), view);
+        return response != nullptr ? response : next(request);
+    }
+};
+
+#endif // ASSETBUNDLE_H
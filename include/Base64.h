@@ -0,0 +1,302 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSSE3__)
+#define SERVERLIB_HAS_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define SERVERLIB_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Base64 encoding and decoding (RFC 4648), standard and URL-safe alphabets
+ * Decoding accepts input with or without '=' padding and rejects any other character,
+ * including whitespace. When compiled with SSSE3 (16 characters per step) or AVX2 (32 per step),
+ * the bulk of the input goes through the vector paths (Mula/Lemire algorithms); the scalar code
+ * handles the tail and targets without them (e.g. ESP32).
+ */
+namespace Base64 {
+
+    static constexpr char kStandardAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static constexpr char kUrlAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    /**
+     * Maps an input character to its 6-bit value, 0xFF for characters outside the alphabet
+     */
+    inline const UInt8* GetDecodeTable(Bool urlSafe) {
+        struct Tables {
+            UInt8 standard[256];
+            UInt8 url[256];
+            Tables() {
+                for (int index = 0; index < 256; ++index) {
+                    standard[index] = 0xFF;
+                    url[index] = 0xFF;
+                }
+                for (int index = 0; index < 64; ++index) {
+                    standard[static_cast<unsigned char>(kStandardAlphabet[index])] = static_cast<UInt8>(index);
+                    url[static_cast<unsigned char>(kUrlAlphabet[index])] = static_cast<UInt8>(index);
+                }
+            }
+        };
+        static const Tables tables;
+        return urlSafe ? tables.url : tables.standard;
+    }
+
+#ifdef SERVERLIB_HAS_SSSE3
+    /**
+     * Reorder 12 input bytes into 16 6-bit indices (one per output byte)
+     */
+    inline __m128i EncodeIndices(__m128i input) {
+        input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        const __m128i high = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+        const __m128i low = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+        return _mm_or_si128(high, low);
+    }
+
+    /**
+     * Map 16 6-bit indices to alphabet characters by adding a per-range offset
+     */
+    inline __m128i EncodeCharacters(__m128i indices, Bool urlSafe) {
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        const __m128i offsets = _mm_setr_epi8(
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            static_cast<char>((urlSafe ? '-' : '+') - 62), static_cast<char>((urlSafe ? '_' : '/') - 63), 'A', 0, 0);
+        return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+    }
+
+    /**
+     * Translate 16 characters to 6-bit values in place
+     * @return false if any character is outside the alphabet
+     */
+    inline Bool DecodeValues(__m128i& input, Bool urlSafe) {
+        if (urlSafe) {
+            // '+' and '/' are not part of the URL alphabet; map '-' and '_' onto them and reuse the standard tables
+            const __m128i standardOnly = _mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8('+')), _mm_cmpeq_epi8(input, _mm_set1_epi8('/')));
+            if (_mm_movemask_epi8(standardOnly) != 0) return false;
+            input = _mm_xor_si128(input, _mm_and_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8('-')), _mm_set1_epi8('-' ^ '+')));
+            input = _mm_xor_si128(input, _mm_and_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8('_')), _mm_set1_epi8('_' ^ '/')));
+        }
+        const __m128i lowTable = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i highTable = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i rollTable = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i mask2F = _mm_set1_epi8(0x2F);
+        const __m128i highNibbles = _mm_and_si128(_mm_srli_epi32(input, 4), mask2F);
+        const __m128i lowNibbles = _mm_and_si128(input, mask2F);
+        const __m128i low = _mm_shuffle_epi8(lowTable, lowNibbles);
+        const __m128i high = _mm_shuffle_epi8(highTable, highNibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128())) != 0xFFFF) return false;
+        const __m128i roll = _mm_shuffle_epi8(rollTable, _mm_add_epi8(_mm_cmpeq_epi8(input, mask2F), highNibbles));
+        input = _mm_add_epi8(input, roll);
+        return true;
+    }
+
+    /**
+     * Pack 16 6-bit values into 12 bytes (in the low 12 lanes)
+     */
+    inline __m128i DecodePack(__m128i values) {
+        const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        return _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    }
+#endif
+
+#ifdef SERVERLIB_HAS_AVX2
+    /**
+     * AVX2 variant of DecodeValues() for 32 characters
+     */
+    inline Bool DecodeValues(__m256i& input, Bool urlSafe) {
+        if (urlSafe) {
+            const __m256i standardOnly = _mm256_or_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8('+')), _mm256_cmpeq_epi8(input, _mm256_set1_epi8('/')));
+            if (_mm256_movemask_epi8(standardOnly) != 0) return false;
+            input = _mm256_xor_si256(input, _mm256_and_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8('-')), _mm256_set1_epi8('-' ^ '+')));
+            input = _mm256_xor_si256(input, _mm256_and_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8('_')), _mm256_set1_epi8('_' ^ '/')));
+        }
+        const __m256i lowTable = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i highTable = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i rollTable = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i mask2F = _mm256_set1_epi8(0x2F);
+        const __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask2F);
+        const __m256i lowNibbles = _mm256_and_si256(input, mask2F);
+        const __m256i low = _mm256_shuffle_epi8(lowTable, lowNibbles);
+        const __m256i high = _mm256_shuffle_epi8(highTable, highNibbles);
+        if (!_mm256_testz_si256(low, high)) return false;
+        const __m256i roll = _mm256_shuffle_epi8(rollTable, _mm256_add_epi8(_mm256_cmpeq_epi8(input, mask2F), highNibbles));
+        input = _mm256_add_epi8(input, roll);
+        return true;
+    }
+#endif
+
+    inline Size GetEncodedLength(Size length, Bool pad = true) {
+        return pad ? (length + 2) / 3 * 4 : (length * 4 + 2) / 3;
+    }
+
+    /**
+     * Upper bound of the decoded size of length input characters
+     */
+    inline Size GetMaxDecodedLength(Size length) {
+        return length / 4 * 3 + (length % 4 == 0 ? 0 : 2);
+    }
+
+    /**
+     * Encode length bytes into out, which must hold GetEncodedLength(length, pad) characters
+     * @return Number of characters written
+     */
+    inline Size EncodeTo(const UInt8* data, Size length, char* out, Bool urlSafe = false, Bool pad = true) {
+        const char* alphabet = urlSafe ? kUrlAlphabet : kStandardAlphabet;
+        char* start = out;
+        Size index = 0;
+#ifdef SERVERLIB_HAS_AVX2
+        // Each step loads 12 bytes per 128-bit lane (28 bytes in all) and stores 32 characters
+        for (; index + 28 <= length; index += 24) {
+            const __m256i input = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + 12)), 1);
+            const __m256i shuffled = _mm256_shuffle_epi8(input, _mm256_setr_epi8(
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+            const __m256i high = _mm256_mulhi_epu16(_mm256_and_si256(shuffled, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+            const __m256i low = _mm256_mullo_epi16(_mm256_and_si256(shuffled, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+            const __m256i indices = _mm256_or_si256(high, low);
+            __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+            range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+            const char plus = static_cast<char>((urlSafe ? '-' : '+') - 62);
+            const char slash = static_cast<char>((urlSafe ? '_' : '/') - 63);
+            const __m256i offsets = _mm256_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, plus, slash, 'A', 0, 0,
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, plus, slash, 'A', 0, 0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices));
+            out += 32;
+        }
+#endif
+#ifdef SERVERLIB_HAS_SSSE3
+        // Each step loads 16 bytes, encodes the first 12 and stores 16 characters
+        for (; index + 16 <= length; index += 12) {
+            const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), EncodeCharacters(EncodeIndices(input), urlSafe));
+            out += 16;
+        }
+#endif
+        for (; index + 3 <= length; index += 3) {
+            const std::uint32_t group = (static_cast<std::uint32_t>(data[index]) << 16) |
+                                        (static_cast<std::uint32_t>(data[index + 1]) << 8) | data[index + 2];
+            *out++ = alphabet[(group >> 18) & 0x3F];
+            *out++ = alphabet[(group >> 12) & 0x3F];
+            *out++ = alphabet[(group >> 6) & 0x3F];
+            *out++ = alphabet[group & 0x3F];
+        }
+        const Size remaining = length - index;
+        if (remaining > 0) {
+            std::uint32_t group = static_cast<std::uint32_t>(data[index]) << 16;
+            if (remaining == 2) group |= static_cast<std::uint32_t>(data[index + 1]) << 8;
+            *out++ = alphabet[(group >> 18) & 0x3F];
+            *out++ = alphabet[(group >> 12) & 0x3F];
+            if (remaining == 2) {
+                *out++ = alphabet[(group >> 6) & 0x3F];
+            } else if (pad) {
+                *out++ = '=';
+            }
+            if (pad) *out++ = '=';
+        }
+        return static_cast<Size>(out - start);
+    }
+
+    /**
+     * Decode input into out, which must hold GetMaxDecodedLength(input.size()) bytes
+     * @return Number of bytes written, or -1 if the input is not valid base64
+     */
+    inline long long DecodeTo(std::string_view input, UInt8* out, Bool urlSafe = false) {
+        Size length = input.size();
+        if (length > 0 && input[length - 1] == '=') --length;
+        if (length > 0 && input[length - 1] == '=') --length;
+        if (length % 4 == 1 || (length != input.size() && input.size() % 4 != 0)) return -1;
+
+        const UInt8* table = GetDecodeTable(urlSafe);
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data());
+        UInt8* start = out;
+        Size index = 0;
+#ifdef SERVERLIB_HAS_AVX2
+        // Each step decodes 32 characters and stores 28 bytes (24 valid), so stay 40 characters from the end
+        for (; index + 40 <= length; index += 32) {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index));
+            if (!DecodeValues(values, urlSafe)) return -1;
+            const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+            const __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+            const __m256i packed = _mm256_shuffle_epi8(words, _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm256_extracti128_si256(packed, 1));
+            out += 24;
+        }
+#endif
+#ifdef SERVERLIB_HAS_SSSE3
+        // Each step decodes 16 characters and stores 16 bytes (12 valid), so stay 24 characters from the end
+        for (; index + 24 <= length; index += 16) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            if (!DecodeValues(values, urlSafe)) return -1;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), DecodePack(values));
+            out += 12;
+        }
+#endif
+        for (; index + 4 <= length; index += 4) {
+            const std::uint32_t a = table[data[index]];
+            const std::uint32_t b = table[data[index + 1]];
+            const std::uint32_t c = table[data[index + 2]];
+            const std::uint32_t d = table[data[index + 3]];
+            if ((a | b | c | d) & 0x80) return -1;
+            const std::uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+            *out++ = static_cast<UInt8>(group >> 16);
+            *out++ = static_cast<UInt8>(group >> 8);
+            *out++ = static_cast<UInt8>(group);
+        }
+        const Size remaining = length - index;
+        if (remaining >= 2) {
+            const std::uint32_t a = table[data[index]];
+            const std::uint32_t b = table[data[index + 1]];
+            const std::uint32_t c = remaining == 3 ? table[data[index + 2]] : 0;
+            if ((a | b | c) & 0x80) return -1;
+            const std::uint32_t group = (a << 18) | (b << 12) | (c << 6);
+            *out++ = static_cast<UInt8>(group >> 16);
+            if (remaining == 3) *out++ = static_cast<UInt8>(group >> 8);
+        }
+        return static_cast<long long>(out - start);
+    }
+
+    inline StdString Encode(std::string_view data, Bool urlSafe = false, Bool pad = true) {
+        StdString out(GetEncodedLength(data.size(), pad), '\0');
+        out.resize(EncodeTo(reinterpret_cast<const UInt8*>(data.data()), data.size(), &out[0], urlSafe, pad));
+        return out;
+    }
+
+    /**
+     * Decode standard (or URL-safe) base64
+     * @return false if the input is not valid base64; out is then empty
+     */
+    inline Bool Decode(std::string_view input, StdString& out, Bool urlSafe = false) {
+        out.resize(GetMaxDecodedLength(input.size()));
+        const long long written = DecodeTo(input, reinterpret_cast<UInt8*>(&out[0]), urlSafe);
+        if (written < 0) {
+            out.clear();
+            return false;
+        }
+        out.resize(static_cast<Size>(written));
+        return true;
+    }
+
+    inline Bool DecodeUrl(std::string_view input, StdString& out) {
+        return Decode(input, out, true);
+    }
+}
+
+#endif // BASE64_H
@@ -0,0 +1,51 @@
+#ifndef BASICAUTHCREDENTIALS_H
+#define BASICAUTHCREDENTIALS_H
+
+#include <StandardDefines.h>
+#include <string_view>
+#include "Base64.h"
+
+/**
+ * Decoded HTTP Basic credentials ("Authorization: Basic base64(user:password)")
+ * Owns the decoded buffer; GetUser() and GetPassword() return views into it that stay valid for
+ * the lifetime of the object they were taken from.
+ */
+class BasicAuthCredentials {
+
+    Private StdString decoded_;
+    Private Size separator_;
+    Private Bool valid_;
+
+    Public BasicAuthCredentials() : separator_(0), valid_(false) {}
+
+    /**
+     * Decode the credentials part of a Basic Authorization header (after "Basic ")
+     */
+    Public explicit BasicAuthCredentials(std::string_view encoded) : separator_(0), valid_(false) {
+        if (!Base64::Decode(encoded, decoded_)) return;
+        const Size colon = decoded_.find(':');
+        if (colon == StdString::npos) {
+            decoded_.clear();
+            return;
+        }
+        separator_ = colon;
+        valid_ = true;
+    }
+
+    /**
+     * True if the header decoded to "user:password"
+     */
+    Public Bool IsValid() const {
+        return valid_;
+    }
+
+    Public std::string_view GetUser() const {
+        return valid_ ? std::string_view(decoded_).substr(0, separator_) : std::string_view();
+    }
+
+    Public std::string_view GetPassword() const {
+        return valid_ ? std::string_view(decoded_).substr(separator_ + 1) : std::string_view();
+    }
+};
+
+#endif // BASICAUTHCREDENTIALS_H
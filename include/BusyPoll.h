@@ -0,0 +1,146 @@
+#ifndef BUSYPOLL_H
+#define BUSYPOLL_H
+
+#include <StandardDefines.h>
+#include <chrono>
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <sys/socket.h>
+#endif
+#ifdef SERVERLIB_LINUX
+#include <sys/epoll.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+/**
+ * Low-latency reactor mode: spin on non-blocking polls before sleeping
+ * Trades a core for microseconds on latency-critical endpoints. Selected per server through
+ * IServer::SetBusyPoll(); the default (disabled) keeps the normal blocking wait.
+ */
+class BusyPollConfig {
+
+    Public Bool enabled = false;
+
+    /**
+     * How long the reactor spins on zero-timeout polls before falling back to a blocking wait (microseconds)
+     */
+    Public UInt spinWindowUs = 50;
+
+    /**
+     * SO_BUSY_POLL on each socket: time the kernel busy-polls the NIC queue on a blocking read (microseconds, 0 = off)
+     */
+    Public UInt socketBusyPollUs = 50;
+
+    /**
+     * SO_PREFER_BUSY_POLL: let busy polling defer NIC interrupts while the application keeps polling
+     */
+    Public Bool preferBusyPoll = true;
+
+    /**
+     * SO_BUSY_POLL_BUDGET: packets processed per busy-poll round (0 = kernel default)
+     */
+    Public UInt busyPollBudget = 0;
+
+    /**
+     * Spin window and socket busy polling sized for latency-critical control endpoints
+     */
+    Public Static BusyPollConfig LowLatency() {
+        BusyPollConfig config;
+        config.enabled = true;
+        config.spinWindowUs = 200;
+        config.socketBusyPollUs = 50;
+        return config;
+    }
+};
+
+namespace BusyPoll {
+
+    // Option numbers from <asm-generic/socket.h>, for libc headers that predate them (Linux 5.11)
+#ifdef SO_PREFER_BUSY_POLL
+    static constexpr int kPreferBusyPollOption = SO_PREFER_BUSY_POLL;
+#else
+    static constexpr int kPreferBusyPollOption = 69;
+#endif
+#ifdef SO_BUSY_POLL_BUDGET
+    static constexpr int kBusyPollBudgetOption = SO_BUSY_POLL_BUDGET;
+#else
+    static constexpr int kBusyPollBudgetOption = 70;
+#endif
+
+    /**
+     * Hint to the CPU that the caller is spinning
+     */
+    inline Void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+        _mm_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+    /**
+     * Apply the per-socket busy-poll options (Linux; ignored elsewhere)
+     * SO_BUSY_POLL above the sysctl net.core.busy_poll value needs CAP_NET_ADMIN, so failures are not fatal.
+     * @return true if every requested option was accepted
+     */
+    inline Bool ApplyToSocket(int fd, const BusyPollConfig& config) {
+        if (!config.enabled) return true;
+#ifdef SERVERLIB_LINUX
+        Bool applied = true;
+#ifdef SO_BUSY_POLL
+        if (config.socketBusyPollUs > 0) {
+            const int value = static_cast<int>(config.socketBusyPollUs);
+            applied = ::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) == 0 && applied;
+        }
+#endif
+        if (config.preferBusyPoll) {
+            const int value = 1;
+            applied = ::setsockopt(fd, SOL_SOCKET, kPreferBusyPollOption, &value, sizeof(value)) == 0 && applied;
+        }
+        if (config.busyPollBudget > 0) {
+            const int value = static_cast<int>(config.busyPollBudget);
+            applied = ::setsockopt(fd, SOL_SOCKET, kBusyPollBudgetOption, &value, sizeof(value)) == 0 && applied;
+        }
+        return applied;
+#else
+        (void)fd;
+        return false;
+#endif
+    }
+
+    /**
+     * Wait for events, spinning first when busy polling is enabled
+     * @param config Busy-poll settings
+     * @param poll Callable int(int timeoutMs) performing one poll (epoll_wait, io_uring peek, ...), returning the event count
+     * @param timeoutMs Timeout for the blocking fallback (-1 = infinite)
+     * @return Result of the last poll call
+     */
+    template<typename PollFn>
+    int Wait(const BusyPollConfig& config, PollFn&& poll, int timeoutMs) {
+        if (config.enabled && config.spinWindowUs > 0) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config.spinWindowUs);
+            do {
+                const int ready = poll(0);
+                if (ready != 0) return ready;
+                CpuRelax();
+            } while (std::chrono::steady_clock::now() < deadline);
+        }
+        return poll(timeoutMs);
+    }
+
+#ifdef SERVERLIB_LINUX
+    /**
+     * epoll_wait with the busy-poll spin window in front of it
+     */
+    inline int WaitEpoll(int epollFd, epoll_event* events, int maxEvents, int timeoutMs, const BusyPollConfig& config) {
+        return Wait(config, [epollFd, events, maxEvents](int timeout) {
+            return ::epoll_wait(epollFd, events, maxEvents, timeout);
+        }, timeoutMs);
+    }
+#endif
+}
+
+#endif // BUSYPOLL_H
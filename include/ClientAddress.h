@@ -0,0 +1,271 @@
+#ifndef CLIENTADDRESS_H
+#define CLIENTADDRESS_H
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+/**
+ * Peer address kept in binary form (IPv4 or IPv6 plus port), formatted only when asked for
+ * 20 bytes instead of a heap-allocated string per request; Format() writes the text form without
+ * inet_ntop (IPv6 uses the RFC 5952 canonical form).
+ */
+class ClientAddress {
+
+    Public Static constexpr UInt8 kNone = 0;
+    Public Static constexpr UInt8 kIPv4 = 4;
+    Public Static constexpr UInt8 kIPv6 = 6;
+
+    /**
+     * Longest formatted address: a full IPv6 address with an embedded IPv4 part
+     */
+    Public Static constexpr Size kMaxStringLength = 45;
+
+    // Network byte order; IPv4 uses the first 4 bytes
+    Private UInt8 bytes_[16];
+    Private std::uint16_t port_;
+    Private UInt8 family_;
+
+    Private Static Size FormatIPv4(const UInt8* bytes, char* out) {
+        char* start = out;
+        for (int index = 0; index < 4; ++index) {
+            UInt value = bytes[index];
+            if (value >= 100) *out++ = static_cast<char>('0' + value / 100);
+            if (value >= 10) *out++ = static_cast<char>('0' + value / 10 % 10);
+            *out++ = static_cast<char>('0' + value % 10);
+            if (index < 3) *out++ = '.';
+        }
+        return static_cast<Size>(out - start);
+    }
+
+    Private Static int HexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    Private Static Bool ParseIPv4(std::string_view text, UInt8* out) {
+        int part = 0;
+        UInt value = 0;
+        Size digits = 0;
+        for (char c : text) {
+            if (c >= '0' && c <= '9') {
+                value = value * 10 + static_cast<UInt>(c - '0');
+                if (++digits > 3 || value > 255) return false;
+            } else if (c == '.' && digits > 0 && part < 3) {
+                out[part++] = static_cast<UInt8>(value);
+                value = 0;
+                digits = 0;
+            } else {
+                return false;
+            }
+        }
+        if (part != 3 || digits == 0) return false;
+        out[3] = static_cast<UInt8>(value);
+        return true;
+    }
+
+    Private Static Bool ParseIPv6(std::string_view text, UInt8* out) {
+        std::uint16_t groups[8] = {};
+        int count = 0;
+        int gap = -1;
+        Size position = 0;
+        if (text.size() >= 2 && text[0] == ':' && text[1] == ':') {
+            gap = 0;
+            position = 2;
+        }
+        while (position < text.size()) {
+            if (count == 8) return false;
+            // Embedded IPv4 in the last 32 bits
+            const Size nextColon = text.find(':', position);
+            const std::string_view group = text.substr(position, nextColon == std::string_view::npos ? std::string_view::npos : nextColon - position);
+            if (nextColon == std::string_view::npos && group.find('.') != std::string_view::npos) {
+                UInt8 ipv4[4];
+                if (count > 6 || !ParseIPv4(group, ipv4)) return false;
+                groups[count++] = static_cast<std::uint16_t>((ipv4[0] << 8) | ipv4[1]);
+                groups[count++] = static_cast<std::uint16_t>((ipv4[2] << 8) | ipv4[3]);
+                position = text.size();
+                break;
+            }
+            if (group.empty() || group.size() > 4) return false;
+            UInt value = 0;
+            for (char c : group) {
+                const int digit = HexValue(c);
+                if (digit < 0) return false;
+                value = (value << 4) | static_cast<UInt>(digit);
+            }
+            groups[count++] = static_cast<std::uint16_t>(value);
+            if (nextColon == std::string_view::npos) {
+                position = text.size();
+            } else if (nextColon + 1 < text.size() && text[nextColon + 1] == ':') {
+                if (gap >= 0) return false;
+                gap = count;
+                position = nextColon + 2;
+            } else {
+                if (nextColon + 1 == text.size()) return false;
+                position = nextColon + 1;
+            }
+        }
+        if (gap < 0 && count != 8) return false;
+        if (gap >= 0 && count == 8) return false;
+        std::uint16_t expanded[8] = {};
+        const int tail = gap < 0 ? 0 : count - gap;
+        for (int index = 0; index < (gap < 0 ? count : gap); ++index) expanded[index] = groups[index];
+        for (int index = 0; index < tail; ++index) expanded[8 - tail + index] = groups[gap + index];
+        for (int index = 0; index < 8; ++index) {
+            out[index * 2] = static_cast<UInt8>(expanded[index] >> 8);
+            out[index * 2 + 1] = static_cast<UInt8>(expanded[index] & 0xFF);
+        }
+        return true;
+    }
+
+    Public ClientAddress() : bytes_(), port_(0), family_(kNone) {}
+
+    /**
+     * @param networkOrderAddress 4 bytes in network byte order
+     */
+    Public Static ClientAddress FromIPv4(const UInt8* networkOrderAddress, std::uint16_t port) {
+        ClientAddress address;
+        std::memcpy(address.bytes_, networkOrderAddress, 4);
+        address.port_ = port;
+        address.family_ = kIPv4;
+        return address;
+    }
+
+    /**
+     * @param networkOrderAddress 16 bytes in network byte order
+     */
+    Public Static ClientAddress FromIPv6(const UInt8* networkOrderAddress, std::uint16_t port) {
+        ClientAddress address;
+        std::memcpy(address.bytes_, networkOrderAddress, 16);
+        address.port_ = port;
+        address.family_ = kIPv6;
+        return address;
+    }
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+    /**
+     * From the address filled in by accept() or getpeername()
+     * @return Empty address for families other than AF_INET/AF_INET6
+     */
+    Public Static ClientAddress FromSockaddr(const sockaddr* address, socklen_t length) {
+        if (address != nullptr && address->sa_family == AF_INET && length >= sizeof(sockaddr_in)) {
+            const sockaddr_in* ipv4 = reinterpret_cast<const sockaddr_in*>(address);
+            return FromIPv4(reinterpret_cast<const UInt8*>(&ipv4->sin_addr), ntohs(ipv4->sin_port));
+        }
+        if (address != nullptr && address->sa_family == AF_INET6 && length >= sizeof(sockaddr_in6)) {
+            const sockaddr_in6* ipv6 = reinterpret_cast<const sockaddr_in6*>(address);
+            return FromIPv6(reinterpret_cast<const UInt8*>(&ipv6->sin6_addr), ntohs(ipv6->sin6_port));
+        }
+        return ClientAddress();
+    }
+#endif
+
+    /**
+     * Parse a textual IPv4 or IPv6 address (no brackets, no zone ID)
+     * @return false if text is not an address; out is left unchanged
+     */
+    Public Static Bool Parse(std::string_view text, std::uint16_t port, ClientAddress& out) {
+        UInt8 bytes[16];
+        if (ParseIPv4(text, bytes)) {
+            out = FromIPv4(bytes, port);
+            return true;
+        }
+        if (text.find(':') != std::string_view::npos && ParseIPv6(text, bytes)) {
+            out = FromIPv6(bytes, port);
+            return true;
+        }
+        return false;
+    }
+
+    Public Bool IsValid() const { return family_ != kNone; }
+    Public Bool IsIPv4() const { return family_ == kIPv4; }
+    Public Bool IsIPv6() const { return family_ == kIPv6; }
+    Public UInt8 GetFamily() const { return family_; }
+    Public std::uint16_t GetPort() const { return port_; }
+    Public Void SetPort(std::uint16_t port) { port_ = port; }
+
+    /**
+     * Address bytes in network byte order (4 for IPv4, 16 for IPv6)
+     */
+    Public const UInt8* GetBytes() const { return bytes_; }
+
+    /**
+     * Write the address (without port) to out, which must hold kMaxStringLength bytes
+     * @return Number of characters written (0 for an empty address); not NUL-terminated
+     */
+    Public Size Format(char* out) const {
+        if (family_ == kIPv4) return FormatIPv4(bytes_, out);
+        if (family_ != kIPv6) return 0;
+
+        std::uint16_t groups[8];
+        for (int index = 0; index < 8; ++index) {
+            groups[index] = static_cast<std::uint16_t>((bytes_[index * 2] << 8) | bytes_[index * 2 + 1]);
+        }
+        char* start = out;
+        // IPv4-mapped addresses print their IPv4 part in dotted form
+        if (groups[0] == 0 && groups[1] == 0 && groups[2] == 0 && groups[3] == 0 && groups[4] == 0 && groups[5] == 0xFFFF) {
+            std::memcpy(out, "::ffff:", 7);
+            return 7 + FormatIPv4(bytes_ + 12, out + 7);
+        }
+        // Compress the longest run of two or more zero groups (the first one on ties)
+        int bestStart = -1;
+        int bestLength = 1;
+        for (int index = 0; index < 8;) {
+            if (groups[index] != 0) {
+                ++index;
+                continue;
+            }
+            int end = index;
+            while (end < 8 && groups[end] == 0) ++end;
+            if (end - index > bestLength) {
+                bestStart = index;
+                bestLength = end - index;
+            }
+            index = end;
+        }
+        static const char kHex[] = "0123456789abcdef";
+        for (int index = 0; index < 8; ++index) {
+            if (index == bestStart) {
+                *out++ = ':';
+                if (index == 0) *out++ = ':';
+                index += bestLength - 1;
+                continue;
+            }
+            const UInt value = groups[index];
+            Bool leading = true;
+            for (int shift = 12; shift >= 0; shift -= 4) {
+                const UInt digit = (value >> shift) & 0xF;
+                if (leading && digit == 0 && shift > 0) continue;
+                leading = false;
+                *out++ = kHex[digit];
+            }
+            if (index < 7) *out++ = ':';
+        }
+        return static_cast<Size>(out - start);
+    }
+
+    Public StdString ToString() const {
+        char buffer[kMaxStringLength];
+        return StdString(buffer, Format(buffer));
+    }
+
+    Public Bool operator==(const ClientAddress& other) const {
+        if (family_ != other.family_ || port_ != other.port_) return false;
+        return std::memcmp(bytes_, other.bytes_, family_ == kIPv4 ? 4 : 16) == 0;
+    }
+
+    Public Bool operator!=(const ClientAddress& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // CLIENTADDRESS_H
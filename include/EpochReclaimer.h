@@ -0,0 +1,440 @@
+#ifndef EPOCHRECLAIMER_H
+#define EPOCHRECLAIMER_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+/**
+ * Epoch-based reclamation: defers freeing shared objects until no reader can still hold them
+ * Readers wrap lock-free accesses in an EpochGuard (two atomic stores, no locks). Writers unlink an
+ * object and Retire() it; its deleter runs only once every thread that was inside a guard at that
+ * time has left it. The domain must outlive all threads that entered it (use Global() for the
+ * server's lifetime).
+ *
+ * Collection runs every kCollectInterval retirements and, while objects are pending, on every
+ * kExitCollectInterval-th outermost guard exit of a thread. A reactor should also call Collect()
+ * from its periodic tick so a quiet server frees its last retired connections.
+ */
+class EpochDomain {
+
+    Public Static constexpr UInt kMaxParticipants = 256;
+
+    // Retired objects are collected every kCollectInterval retirements
+    Private Static constexpr UInt kCollectInterval = 64;
+
+    // ...and every kExitCollectInterval guard exits of a thread while any are pending
+    Private Static constexpr UInt kExitCollectInterval = 16;
+
+    /**
+     * One reader thread's announced epoch, on its own cache line
+     */
+    Private class alignas(64) Participant {
+        // Epoch the thread entered at, 0 while it is outside every guard
+        Public std::atomic<std::uint64_t> epoch{ 0 };
+        Public std::atomic<Bool> claimed{ false };
+    };
+
+    Private class Retired {
+        Public std::uint64_t epoch;
+        Public std::function<Void()> deleter;
+    };
+
+    /**
+     * Per-thread participant slots and guard nesting, released at thread exit
+     */
+    Private class ThreadRecord {
+        Public EpochDomain* domain = nullptr;
+        Public UInt slot = 0;
+        Public UInt depth = 0;
+        Public UInt exitsSinceCollect = 0;
+    };
+
+    Private class ThreadRecords {
+        Public StdVector<ThreadRecord> records;
+        Public ~ThreadRecords() {
+            for (const ThreadRecord& record : records) {
+                record.domain->participants_[record.slot].claimed.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    Private std::atomic<std::uint64_t> globalEpoch_;
+    Private Participant participants_[kMaxParticipants];
+    Private std::mutex retiredMutex_;
+    Private StdVector<Retired> retired_;
+    Private std::atomic<Size> retiredCount_;
+    Private std::atomic<ULong> reclaimedCount_;
+    Private std::atomic<Bool> collecting_;
+
+    Private Static ThreadRecords& GetThreadRecords() {
+        thread_local ThreadRecords records;
+        return records;
+    }
+
+    Private ThreadRecord& GetThreadRecord() {
+        ThreadRecords& records = GetThreadRecords();
+        for (ThreadRecord& record : records.records) {
+            if (record.domain == this) return record;
+        }
+        ThreadRecord record;
+        record.domain = this;
+        // More live threads than slots: wait for one to exit rather than read unprotected
+        for (;;) {
+            for (UInt slot = 0; slot < kMaxParticipants; ++slot) {
+                Bool expected = false;
+                if (participants_[slot].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    record.slot = slot;
+                    records.records.push_back(record);
+                    return records.records.back();
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    Public EpochDomain() : globalEpoch_(1), retiredCount_(0), reclaimedCount_(0), collecting_(false) {}
+
+    /**
+     * Runs every pending deleter; no thread may be inside a guard of this domain
+     */
+    Public ~EpochDomain() {
+        for (Retired& entry : retired_) {
+            entry.deleter();
+        }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    /**
+     * Process-wide domain shared by the server's connection tables
+     */
+    Public Static EpochDomain& Global() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    /**
+     * Announce that the calling thread may read shared objects; prefer EpochGuard
+     */
+    Public Void Enter() {
+        ThreadRecord& record = GetThreadRecord();
+        if (record.depth++ > 0) return;
+        Participant& participant = participants_[record.slot];
+        participant.epoch.store(globalEpoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // The announcement must be visible before any shared pointer is loaded
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    Public Void Exit() {
+        ThreadRecord& record = GetThreadRecord();
+        if (--record.depth > 0) return;
+        participants_[record.slot].epoch.store(0, std::memory_order_release);
+        if (retiredCount_.load(std::memory_order_relaxed) == 0) return;
+        if (++record.exitsSinceCollect < kExitCollectInterval) return;
+        record.exitsSinceCollect = 0;
+        TryCollect();
+    }
+
+    /**
+     * Defer a deleter until no reader that might see the unlinked object remains
+     * Call only after the object is unreachable for new readers.
+     */
+    Public Void Retire(std::function<Void()> deleter) {
+        Size pending;
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex_);
+            retired_.push_back(Retired{ globalEpoch_.load(std::memory_order_acquire), std::move(deleter) });
+            pending = retired_.size();
+            retiredCount_.store(pending, std::memory_order_relaxed);
+        }
+        if (pending % kCollectInterval == 0) TryCollect();
+    }
+
+    /**
+     * Retire an object allocated with new
+     */
+    template<typename T>
+    Void Retire(T* object) {
+        Retire([object]() { delete object; });
+    }
+
+    /**
+     * Advance the epoch if every active reader has caught up, then run the deleters that are safe
+     * Call from the reactor's periodic tick; an object needs two epoch advances, so two calls with
+     * no reader stuck in a guard free everything retired before the first.
+     * @return Number of deleters run
+     */
+    Public Size Collect() {
+        TryAdvance();
+        const std::uint64_t safeBelow = globalEpoch_.load(std::memory_order_acquire) - 1;
+        StdVector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex_);
+            Size kept = 0;
+            for (Size index = 0; index < retired_.size(); ++index) {
+                // Readers are at most one epoch behind the global epoch, so anything retired two epochs ago is unreachable
+                if (retired_[index].epoch < safeBelow) {
+                    ready.push_back(std::move(retired_[index]));
+                } else {
+                    if (kept != index) retired_[kept] = std::move(retired_[index]);
+                    ++kept;
+                }
+            }
+            retired_.resize(kept);
+            retiredCount_.store(kept, std::memory_order_relaxed);
+        }
+        for (Retired& entry : ready) {
+            entry.deleter();
+        }
+        reclaimedCount_.fetch_add(ready.size(), std::memory_order_relaxed);
+        return ready.size();
+    }
+
+    Public std::uint64_t GetEpoch() const {
+        return globalEpoch_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Objects retired but not yet freed
+     */
+    Public Size GetPendingCount() const {
+        return retiredCount_.load(std::memory_order_relaxed);
+    }
+
+    Public ULong GetReclaimedCount() const {
+        return reclaimedCount_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Collect unless another thread already is (a deleter entering a guard must not recurse)
+     */
+    Private Void TryCollect() {
+        if (collecting_.exchange(true, std::memory_order_acquire)) return;
+        Collect();
+        collecting_.store(false, std::memory_order_release);
+    }
+
+    Private Void TryAdvance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t current = globalEpoch_.load(std::memory_order_acquire);
+        for (UInt slot = 0; slot < kMaxParticipants; ++slot) {
+            const std::uint64_t announced = participants_[slot].epoch.load(std::memory_order_acquire);
+            if (announced != 0 && announced != current) return;
+        }
+        globalEpoch_.compare_exchange_strong(current, current + 1, std::memory_order_acq_rel);
+    }
+};
+
+/**
+ * Scope in which objects protected by an EpochDomain may be dereferenced
+ */
+class EpochGuard {
+
+    Private EpochDomain& domain_;
+
+    Public explicit EpochGuard(EpochDomain& domain = EpochDomain::Global()) : domain_(domain) {
+        domain_.Enter();
+    }
+
+    Public ~EpochGuard() {
+        domain_.Exit();
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+/**
+ * Map from request ID to connection object with lock-free lookups
+ * Worker threads look up a connection and write to it while the reactor may be closing it: Remove()
+ * unlinks the entry and hands the connection to the epoch domain, so it is destroyed only after
+ * every concurrent With() call has returned. Fixed capacity with linear probing. Insert() and
+ * Remove() are serialized by a writer mutex (normally only the reactor calls them); With() and
+ * Contains() take no lock. Removed buckets become tombstones that Insert() reuses; once they
+ * exceed a quarter of the buckets the table is rebuilt without them, so lookups of absent IDs
+ * keep hitting an empty bucket early.
+ *
+ *   ConnectionTable<Connection> connections(4096);
+ *   connections.Insert(requestId, new Connection(fd));                       // reactor
+ *   connections.With(requestId, [&](Connection& c) { c.Send(response); });   // any worker
+ *   connections.Remove(requestId);                                           // reactor on close
+ */
+template<typename T>
+class ConnectionTable {
+
+    Private class Entry {
+        Public StdString key;
+        Public std::uint64_t hash;
+        Public T* value;
+    };
+
+    /**
+     * Bucket array; replaced as a whole on rehash and retired through the epoch domain
+     */
+    Private class Buckets {
+        Public Size mask;
+        Public StdVector<std::atomic<Entry*>> slots;
+
+        Public explicit Buckets(Size count) : mask(count - 1), slots(count) {
+            for (std::atomic<Entry*>& slot : slots) {
+                slot.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    Private EpochDomain& domain_;
+    Private std::atomic<Buckets*> buckets_;
+    Private std::atomic<Size> size_;
+    Private std::mutex writeMutex_;
+    // Tombstones in the current bucket array, guarded by writeMutex_
+    Private Size tombstones_;
+
+    // Marks a removed bucket; probing continues past it and inserts may reuse it
+    Private Static Entry* Tombstone() {
+        static Entry tombstone{ StdString(), 0, nullptr };
+        return &tombstone;
+    }
+
+    Private Static Size RoundUpToPowerOfTwo(Size value) {
+        Size result = 16;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    Private Static std::uint64_t Hash(std::string_view key) {
+        return static_cast<std::uint64_t>(std::hash<std::string_view>()(key));
+    }
+
+    /**
+     * @param capacity Maximum number of live connections (rounded up to a power of two, kept at most half full)
+     * @param domain Epoch domain deferring destruction of removed connections
+     */
+    Public explicit ConnectionTable(Size capacity, EpochDomain& domain = EpochDomain::Global())
+        : domain_(domain), buckets_(new Buckets(RoundUpToPowerOfTwo(capacity * 2))), size_(0), tombstones_(0) {}
+
+    /**
+     * Deletes the remaining connections; no thread may use the table concurrently
+     */
+    Public ~ConnectionTable() {
+        Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+        for (std::atomic<Entry*>& slot : buckets->slots) {
+            Entry* entry = slot.load(std::memory_order_relaxed);
+            if (entry != nullptr && entry != Tombstone()) {
+                delete entry->value;
+                delete entry;
+            }
+        }
+        delete buckets;
+    }
+
+    ConnectionTable(const ConnectionTable&) = delete;
+    ConnectionTable& operator=(const ConnectionTable&) = delete;
+
+    /**
+     * Add a connection, taking ownership
+     * @return false if the table is full (the connection is not taken)
+     */
+    Public Bool Insert(CStdString& requestId, T* connection) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+        if (size_.load(std::memory_order_relaxed) >= (buckets->mask + 1) / 2) return false;
+        const std::uint64_t hash = Hash(requestId);
+        for (Size probe = 0; probe <= buckets->mask; ++probe) {
+            std::atomic<Entry*>& slot = buckets->slots[(hash + probe) & buckets->mask];
+            Entry* current = slot.load(std::memory_order_relaxed);
+            if (current != nullptr && current != Tombstone()) continue;
+            if (current == Tombstone()) --tombstones_;
+            // Release: a reader that loads the pointer sees the initialized entry
+            slot.store(new Entry{ requestId, hash, connection }, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Run fn on the connection while it is guaranteed to stay alive
+     * @return false if no connection has this request ID
+     */
+    template<typename Fn>
+    Bool With(std::string_view requestId, Fn&& fn) {
+        EpochGuard guard(domain_);
+        Entry* entry = Find(requestId);
+        if (entry == nullptr) return false;
+        fn(*entry->value);
+        return true;
+    }
+
+    Public Bool Contains(std::string_view requestId) {
+        EpochGuard guard(domain_);
+        return Find(requestId) != nullptr;
+    }
+
+    /**
+     * Unlink a connection; it is destroyed once no With() call can still be using it
+     * @return false if no connection has this request ID
+     */
+    Public Bool Remove(std::string_view requestId) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+        const std::uint64_t hash = Hash(requestId);
+        for (Size probe = 0; probe <= buckets->mask; ++probe) {
+            std::atomic<Entry*>& slot = buckets->slots[(hash + probe) & buckets->mask];
+            Entry* entry = slot.load(std::memory_order_relaxed);
+            if (entry == nullptr) return false;
+            if (entry == Tombstone() || entry->hash != hash || entry->key != requestId) continue;
+            slot.store(Tombstone(), std::memory_order_release);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            domain_.Retire([entry]() {
+                delete entry->value;
+                delete entry;
+            });
+            if (++tombstones_ > (buckets->mask + 1) / 4) Rehash(buckets);
+            return true;
+        }
+        return false;
+    }
+
+    Public Size GetSize() const {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Publish a copy of the bucket array holding only the live entries (writer mutex held)
+     * Entries move to the new array as they are; readers still probing the old one finish there.
+     */
+    Private Void Rehash(Buckets* current) {
+        Buckets* rebuilt = new Buckets(current->mask + 1);
+        for (std::atomic<Entry*>& slot : current->slots) {
+            Entry* entry = slot.load(std::memory_order_relaxed);
+            if (entry == nullptr || entry == Tombstone()) continue;
+            Size index = entry->hash & rebuilt->mask;
+            while (rebuilt->slots[index].load(std::memory_order_relaxed) != nullptr) {
+                index = (index + 1) & rebuilt->mask;
+            }
+            rebuilt->slots[index].store(entry, std::memory_order_relaxed);
+        }
+        buckets_.store(rebuilt, std::memory_order_release);
+        tombstones_ = 0;
+        domain_.Retire(current);
+    }
+
+    Private Entry* Find(std::string_view requestId) const {
+        const Buckets* buckets = buckets_.load(std::memory_order_acquire);
+        const std::uint64_t hash = Hash(requestId);
+        for (Size probe = 0; probe <= buckets->mask; ++probe) {
+            Entry* entry = buckets->slots[(hash + probe) & buckets->mask].load(std::memory_order_acquire);
+            if (entry == nullptr) return nullptr;
+            if (entry != Tombstone() && entry->hash == hash && entry->key == requestId) return entry;
+        }
+        return nullptr;
+    }
+};
+
+#endif // EPOCHRECLAIMER_H
@@ -0,0 +1,69 @@
+#ifndef FASTHASH_H
+#define FASTHASH_H
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * Fast non-cryptographic 64-bit hash for cache and table keys
+ * Processes 8 bytes per step (little-endian word loads) and finishes with the MurmurHash3 fmix64
+ * avalanche. Not collision-resistant against attackers: tables keyed by it must still compare the
+ * full key.
+ */
+namespace FastHash {
+
+    static constexpr std::uint64_t kMultiplier1 = 0x87C37B91114253D5ULL;
+    static constexpr std::uint64_t kMultiplier2 = 0x4CF5AD432745937FULL;
+
+    inline std::uint64_t RotateLeft(std::uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline std::uint64_t Mix(std::uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDULL;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    inline std::uint64_t LoadWord(const unsigned char* data) {
+        std::uint64_t word = 0;
+        for (int index = 7; index >= 0; --index) word = (word << 8) | data[index];
+        return word;
+    }
+
+    inline std::uint64_t Hash64(const void* data, Size length, std::uint64_t seed = 0) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        std::uint64_t hash = seed ^ (static_cast<std::uint64_t>(length) * kMultiplier1);
+        Size offset = 0;
+        for (; offset + 8 <= length; offset += 8) {
+            std::uint64_t word = LoadWord(bytes + offset);
+            word *= kMultiplier1;
+            word = RotateLeft(word, 31);
+            word *= kMultiplier2;
+            hash ^= word;
+            hash = RotateLeft(hash, 27) * 5 + 0x52DCE729;
+        }
+        std::uint64_t tail = 0;
+        for (Size index = length; index > offset; --index) {
+            tail = (tail << 8) | bytes[index - 1];
+        }
+        if (offset < length) {
+            tail *= kMultiplier2;
+            tail = RotateLeft(tail, 33);
+            tail *= kMultiplier1;
+            hash ^= tail;
+        }
+        return Mix(hash);
+    }
+
+    inline std::uint64_t Hash64(std::string_view text, std::uint64_t seed = 0) {
+        return Hash64(text.data(), text.size(), seed);
+    }
+}
+
+#endif // FASTHASH_H
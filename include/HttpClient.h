@@ -0,0 +1,434 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "HttpResponseParser.h"
+#include "RequestIdGenerator.h"
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Request sent by HttpClient to an upstream
+ * Host is filled in from the upstream address unless set here; Content-Length is added for a body.
+ */
+class HttpClientRequest {
+
+    Public StdString method = "GET";
+    Public StdString target = "/";
+    Public StdMap<StdString, StdString> headers;
+    Public StdString body;
+
+    Public HttpClientRequest() = default;
+
+    Public HttpClientRequest(StdString requestMethod, StdString requestTarget, StdString requestBody = StdString())
+        : method(std::move(requestMethod)), target(std::move(requestTarget)), body(std::move(requestBody)) {}
+};
+
+/**
+ * Keep-alive connections to one upstream (host:port)
+ * Connections are returned to the pool after a response that allows reuse and handed out again
+ * most-recently-used first. Thread-safe; a connection is used by one request stream at a time.
+ */
+class UpstreamPool {
+
+    Private StdString host_;
+    Private UInt port_;
+    Private Size maxIdle_;
+    Private std::mutex mutex_;
+    Private StdVector<int> idle_;
+    Private std::atomic<ULong> connects_;
+    Private std::atomic<ULong> reuses_;
+
+    Private Static Void CloseSocket(int fd) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        ::close(fd);
+#else
+        (void)fd;
+#endif
+    }
+
+    /**
+     * Non-blocking connect to each resolved address in turn, bounded by the deadline
+     */
+    Private int Connect(int timeoutMs) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* results = nullptr;
+        const StdString service = std::to_string(port_);
+        if (::getaddrinfo(host_.c_str(), service.c_str(), &hints, &results) != 0) return -1;
+
+        int connected = -1;
+        for (addrinfo* address = results; address != nullptr && connected < 0; address = address->ai_next) {
+            const int fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (fd < 0) continue;
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            int result = ::connect(fd, address->ai_addr, address->ai_addrlen);
+            if (result != 0 && errno == EINPROGRESS) {
+                pollfd entry{ fd, POLLOUT, 0 };
+                int error = 0;
+                socklen_t length = sizeof(error);
+                if (::poll(&entry, 1, timeoutMs) == 1 &&
+                    ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+                    result = 0;
+                }
+            }
+            if (result != 0) {
+                ::close(fd);
+                continue;
+            }
+            const int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            connected = fd;
+        }
+        ::freeaddrinfo(results);
+        if (connected >= 0) connects_.fetch_add(1, std::memory_order_relaxed);
+        return connected;
+#else
+        (void)timeoutMs;
+        return -1;
+#endif
+    }
+
+    /**
+     * @param maxIdle Idle connections kept open; further released connections are closed
+     */
+    Public UpstreamPool(StdString host, UInt port, Size maxIdle = 32)
+        : host_(std::move(host)), port_(port), maxIdle_(maxIdle), connects_(0), reuses_(0) {}
+
+    UpstreamPool(const UpstreamPool&) = delete;
+    UpstreamPool& operator=(const UpstreamPool&) = delete;
+
+    Public ~UpstreamPool() {
+        Clear();
+    }
+
+    /**
+     * An idle connection, or a new one
+     * @param reused Set to true if the connection was taken from the pool (the upstream may have closed it meanwhile)
+     * @return Connected non-blocking socket, or -1 if connecting failed or timed out
+     */
+    Public int Acquire(int timeoutMs, Bool& reused) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+                const int fd = idle_.back();
+                idle_.pop_back();
+                reused = true;
+                reuses_.fetch_add(1, std::memory_order_relaxed);
+                return fd;
+            }
+        }
+        reused = false;
+        return Connect(timeoutMs);
+    }
+
+    /**
+     * Return a connection after use
+     * @param reusable false if the response ended the connection (Connection: close, error, timeout)
+     */
+    Public Void Release(int fd, Bool reusable) {
+        if (fd < 0) return;
+        if (reusable) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (idle_.size() < maxIdle_) {
+                idle_.push_back(fd);
+                return;
+            }
+        }
+        CloseSocket(fd);
+    }
+
+    /**
+     * Close all idle connections
+     */
+    Public Void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int fd : idle_) CloseSocket(fd);
+        idle_.clear();
+    }
+
+    Public CStdString& GetHost() const { return host_; }
+    Public UInt GetPort() const { return port_; }
+    Public ULong GetConnectCount() const { return connects_.load(std::memory_order_relaxed); }
+    Public ULong GetReuseCount() const { return reuses_.load(std::memory_order_relaxed); }
+
+    Public Size GetIdleCount() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return idle_.size();
+    }
+};
+
+DefineStandardPointers(UpstreamPool)
+
+/**
+ * HTTP/1.1 client for calls from handlers to other (local) services
+ * Keeps a pool of keep-alive connections per upstream and parses responses with HttpResponseParser
+ * into IHttpResponse. Every call is bounded by a deadline covering connect, send and receive.
+ * A request that fails on a reused connection before any response byte arrived (the upstream closed
+ * the idle connection) is retried once on a new connection if its method is idempotent.
+ *
+ *   HttpClient client;
+ *   IHttpResponsePtr response = client.Send("127.0.0.1", 8081, HttpClientRequest("GET", "/users/42"));
+ *   if (response == nullptr) { ... connection failed or timed out ... }
+ */
+class HttpClient {
+
+    Private std::mutex mutex_;
+    Private StdMap<StdString, UpstreamPoolPtr> pools_;
+    Private int timeoutMs_;
+    Private Size maxIdlePerUpstream_;
+    Private Bool keepRawResponses_;
+
+    Private Static Bool IsIdempotent(CStdString& method) {
+        return method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE" ||
+               method == "OPTIONS" || method == "TRACE";
+    }
+
+    Private Static Bool EqualsIgnoreCase(CStdString& value, const char* lowerLiteral) {
+        Size i = 0;
+        for (; i < value.length() && lowerLiteral[i] != '\0'; ++i) {
+            if (static_cast<char>(::tolower(static_cast<unsigned char>(value[i]))) != lowerLiteral[i]) return false;
+        }
+        return i == value.length() && lowerLiteral[i] == '\0';
+    }
+
+    Private Static int RemainingMs(std::chrono::steady_clock::time_point deadline) {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        return left > 0 ? static_cast<int>(left) : 0;
+    }
+
+    Private Static Void AppendRequest(StdString& out, const HttpClientRequest& request, CStdString& hostHeader) {
+        out += request.method;
+        out += ' ';
+        out += request.target;
+        out += " HTTP/1.1\r\n";
+        Bool hasHost = false;
+        Bool hasLength = false;
+        for (const auto& header : request.headers) {
+            if (EqualsIgnoreCase(header.first, "host")) hasHost = true;
+            if (EqualsIgnoreCase(header.first, "content-length")) hasLength = true;
+            out += header.first;
+            out += ": ";
+            out += header.second;
+            out += "\r\n";
+        }
+        if (!hasHost) {
+            out += "Host: ";
+            out += hostHeader;
+            out += "\r\n";
+        }
+        if (!hasLength && (!request.body.empty() || request.method == "POST" || request.method == "PUT")) {
+            out += "Content-Length: ";
+            out += std::to_string(request.body.length());
+            out += "\r\n";
+        }
+        out += "\r\n";
+        out += request.body;
+    }
+
+    /**
+     * Write all bytes to a non-blocking socket before the deadline (also used by TrafficReplay)
+     */
+    Public Static Bool WriteAll(int fd, const char* data, Size length, std::chrono::steady_clock::time_point deadline) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+        Size offset = 0;
+        while (offset < length) {
+            const ssize_t sent = ::send(fd, data + offset, length - offset, flags);
+            if (sent > 0) {
+                offset += static_cast<Size>(sent);
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                pollfd entry{ fd, POLLOUT, 0 };
+                if (::poll(&entry, 1, RemainingMs(deadline)) != 1) return false;
+                continue;
+            }
+            return false;
+        }
+        return true;
+#else
+        (void)fd; (void)data; (void)length; (void)deadline;
+        return false;
+#endif
+    }
+
+    /**
+     * Read from a non-blocking socket until the parser holds a complete response (also used by TrafficReplay)
+     * @param received Set to true once any byte has arrived
+     */
+    Public Static Bool ReadResponse(int fd, HttpResponseParser& parser, std::chrono::steady_clock::time_point deadline, Bool& received) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        const Size kReadSize = 16 * 1024;
+        HttpResponseParseStatus status = parser.Parse();
+        while (status == HttpResponseParseStatus::NeedMore) {
+            // Receive straight into the parser's buffer
+            const ssize_t count = ::recv(fd, parser.PrepareWrite(kReadSize), kReadSize, 0);
+            if (count > 0) {
+                received = true;
+                status = parser.Commit(static_cast<Size>(count));
+                continue;
+            }
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                pollfd entry{ fd, POLLIN, 0 };
+                if (::poll(&entry, 1, RemainingMs(deadline)) != 1) return false;
+                continue;
+            }
+            // End of stream completes a close-delimited body; a reset or a truncated response fails
+            if (count < 0) return false;
+            status = parser.Finish();
+        }
+        return status == HttpResponseParseStatus::Complete;
+#else
+        (void)fd; (void)parser; (void)deadline; (void)received;
+        return false;
+#endif
+    }
+
+    /**
+     * Send the requests in one write and read the responses in order on one connection
+     * @return Responses received (all of them on success); reusable tells whether the connection can be pooled
+     */
+    Private StdVector<IHttpResponsePtr> Exchange(int fd, const StdVector<HttpClientRequest>& requests, CStdString& hostHeader,
+                                                 std::chrono::steady_clock::time_point deadline, Bool& received, Bool& reusable) {
+        StdVector<IHttpResponsePtr> responses;
+        reusable = false;
+        StdString wire;
+        for (const HttpClientRequest& request : requests) AppendRequest(wire, request, hostHeader);
+        if (!WriteAll(fd, wire.data(), wire.length(), deadline)) return responses;
+
+        HttpResponseParser parser(keepRawResponses_);
+        Bool keepAlive = true;
+        for (const HttpClientRequest& request : requests) {
+            while (true) {
+                parser.ExpectNoBody(request.method == "HEAD");
+                if (!ReadResponse(fd, parser, deadline, received)) return responses;
+                // Interim 1xx responses (e.g. 100 Continue) precede the final response
+                const UInt code = parser.GetStatusCode();
+                if (code >= 100 && code < 200 && code != 101) {
+                    parser.TakeResponse(StdString());
+                    continue;
+                }
+                break;
+            }
+            keepAlive = parser.IsKeepAlive();
+            responses.push_back(parser.TakeResponse(RequestIdGenerator::NextString()));
+            if (!keepAlive) break;
+        }
+        // Unread bytes after the last expected response mean the stream is out of sync
+        reusable = keepAlive && responses.size() == requests.size() && !parser.HasBufferedData();
+        return responses;
+    }
+
+    /**
+     * @param timeoutMs Deadline for each Send() / SendPipelined() call, from connect to the last response byte
+     * @param maxIdlePerUpstream Idle keep-alive connections kept per upstream
+     * @param keepRawResponses Also keep each response's received bytes for GetRawResponse() (one more copy)
+     */
+    Public explicit HttpClient(int timeoutMs = 5000, Size maxIdlePerUpstream = 32, Bool keepRawResponses = false)
+        : timeoutMs_(timeoutMs), maxIdlePerUpstream_(maxIdlePerUpstream), keepRawResponses_(keepRawResponses) {}
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    /**
+     * Connection pool for an upstream, created on first use
+     */
+    Public UpstreamPoolPtr GetPool(CStdString& host, UInt port) {
+        const StdString key = host + ":" + std::to_string(port);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = pools_.find(key);
+        if (found != pools_.end()) return found->second;
+        UpstreamPoolPtr pool = std::make_shared<UpstreamPool>(host, port, maxIdlePerUpstream_);
+        pools_.emplace(key, pool);
+        return pool;
+    }
+
+    /**
+     * Send several requests on one connection without waiting for each response (HTTP/1.1 pipelining)
+     * Only use with upstreams known to support pipelining; if the connection ends early, the
+     * returned vector is shorter than requests.
+     * @return Responses in request order
+     */
+    Public StdVector<IHttpResponsePtr> SendPipelined(CStdString& host, UInt port, const StdVector<HttpClientRequest>& requests) {
+        if (requests.empty()) return StdVector<IHttpResponsePtr>();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs_);
+        UpstreamPoolPtr pool = GetPool(host, port);
+        const StdString hostHeader = host + ":" + std::to_string(port);
+
+        Bool idempotent = true;
+        for (const HttpClientRequest& request : requests) idempotent = idempotent && IsIdempotent(request.method);
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            Bool reused = false;
+            const int fd = pool->Acquire(RemainingMs(deadline), reused);
+            if (fd < 0) return StdVector<IHttpResponsePtr>();
+            Bool received = false;
+            Bool reusable = false;
+            StdVector<IHttpResponsePtr> responses = Exchange(fd, requests, hostHeader, deadline, received, reusable);
+            pool->Release(fd, reusable);
+            if (!responses.empty() || received || !reused || !idempotent) return responses;
+            // Stale pooled connection: retry once on a fresh one
+        }
+        return StdVector<IHttpResponsePtr>();
+    }
+
+    /**
+     * Send one request and wait for its response
+     * @return The response, or nullptr on connect failure, timeout or a malformed response
+     */
+    Public IHttpResponsePtr Send(CStdString& host, UInt port, const HttpClientRequest& request) {
+        StdVector<IHttpResponsePtr> responses = SendPipelined(host, port, StdVector<HttpClientRequest>{ request });
+        return responses.empty() ? nullptr : responses.front();
+    }
+
+    /**
+     * Change the per-call deadline; call before the client is shared between threads
+     */
+    Public Void SetTimeoutMs(int timeoutMs) {
+        timeoutMs_ = timeoutMs;
+    }
+
+    Public int GetTimeoutMs() const {
+        return timeoutMs_;
+    }
+
+    /**
+     * Close all idle connections to all upstreams
+     */
+    Public Void CloseIdle() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& pool : pools_) pool.second->Clear();
+    }
+};
+
+#endif // HTTPCLIENT_H
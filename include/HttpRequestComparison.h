@@ -0,0 +1,74 @@
+#ifndef HTTPREQUESTCOMPARISON_H
+#define HTTPREQUESTCOMPARISON_H
+
+#include <StandardDefines.h>
+#include "IHttpRequest.h"
+
+/**
+ * Helpers for differential testing of IHttpRequest implementations
+ * A harness (libFuzzer target, corpus replay, ...) parses the same bytes with SimpleHttpRequest and
+ * with the implementation under test, then reports every field on which they disagree.
+ */
+namespace HttpRequestComparison {
+
+    /**
+     * Append "<field>" to differences for every key whose value differs between two maps
+     */
+    inline Void CompareMaps(CStdString& field,
+                            const StdMap<StdString, StdString>& expected,
+                            const StdMap<StdString, StdString>& actual,
+                            StdVector<StdString>& differences) {
+        for (const auto& pair : expected) {
+            auto it = actual.find(pair.first);
+            if (it == actual.end() || it->second != pair.second) {
+                differences.push_back(field + "[" + pair.first + "]");
+            }
+        }
+        for (const auto& pair : actual) {
+            if (expected.find(pair.first) == expected.end()) {
+                differences.push_back(field + "[" + pair.first + "]");
+            }
+        }
+    }
+
+    /**
+     * Compare two parsed requests field by field
+     * Timestamps and client address are not compared: they come from the connection, not the bytes.
+     * @param expected Reference parse (normally SimpleHttpRequest)
+     * @param actual Parse under test
+     * @return Names of the differing fields, empty if both parses agree
+     */
+    inline StdVector<StdString> Compare(const IHttpRequest& expected, const IHttpRequest& actual) {
+        StdVector<StdString> differences;
+        if (expected.GetMethod() != actual.GetMethod()) differences.push_back("method");
+        if (expected.GetPath() != actual.GetPath()) differences.push_back("path");
+        if (expected.GetFullUrl() != actual.GetFullUrl()) differences.push_back("fullUrl");
+        if (expected.GetHttpVersion() != actual.GetHttpVersion()) differences.push_back("httpVersion");
+        CompareMaps("query", expected.GetQueryParameters(), actual.GetQueryParameters(), differences);
+        CompareMaps("header", expected.GetHeaders(), actual.GetHeaders(), differences);
+        CompareMaps("cookie", expected.GetCookies(), actual.GetCookies(), differences);
+        if (expected.GetBody() != actual.GetBody()) differences.push_back("body");
+        if (expected.GetBodyBytes() != actual.GetBodyBytes()) differences.push_back("bodyBytes");
+        if (expected.GetContentLength() != actual.GetContentLength()) differences.push_back("contentLength");
+        if (expected.HasBody() != actual.HasBody()) differences.push_back("hasBody");
+        if (expected.IsJson() != actual.IsJson()) differences.push_back("isJson");
+        if (expected.IsFormData() != actual.IsFormData()) differences.push_back("isFormData");
+        if (expected.IsMultipart() != actual.IsMultipart()) differences.push_back("isMultipart");
+        if (expected.GetBearerToken() != actual.GetBearerToken()) differences.push_back("bearerToken");
+        if (expected.GetBasicAuth() != actual.GetBasicAuth()) differences.push_back("basicAuth");
+        if (expected.GetRawRequest() != actual.GetRawRequest()) differences.push_back("rawRequest");
+        if (expected.GetRequestId() != actual.GetRequestId()) differences.push_back("requestId");
+        return differences;
+    }
+
+    /**
+     * Parse rawRequest with SimpleHttpRequest and compare it against a parse under test
+     * Convenient as the body of a differential fuzz target.
+     */
+    inline StdVector<StdString> CompareWithReference(CStdString& rawRequest, const IHttpRequest& actual) {
+        SimpleHttpRequest reference(actual.GetRequestId(), rawRequest);
+        return Compare(reference, actual);
+    }
+}
+
+#endif // HTTPREQUESTCOMPARISON_H
@@ -0,0 +1,294 @@
+#ifndef HTTPREQUESTHEADGUARD_H
+#define HTTPREQUESTHEADGUARD_H
+
+#include <StandardDefines.h>
+#include <algorithm>
+#include <cctype>
+#include "HttpRequestLimits.h"
+#include "IHttpResponse.h"
+
+/**
+ * Result of feeding bytes to an HttpRequestHeadGuard
+ */
+enum class HttpHeadStatus {
+    NeedMore,               // Head not complete yet, keep reading
+    Complete,               // Blank line seen; GetHeadLength() bytes form the head
+    RequestLineTooLong,     // 414 URI Too Long
+    TooManyHeaders,         // 431 Request Header Fields Too Large
+    HeaderTooLarge,         // 431 Request Header Fields Too Large
+    HeadersTooLarge,        // 431 Request Header Fields Too Large
+    Malformed               // 400 Bad Request (including ambiguous message framing)
+};
+
+/**
+ * Incremental validator for the request line and header block
+ * Server implementations feed every received chunk through Feed() before appending it to their
+ * buffer, and stop reading as soon as a limit is exceeded, so an oversized head is never buffered.
+ * Only the current line is held (bounded by the limits), regardless of how the bytes are split.
+ *
+ * Besides the size limits the guard rejects heads that could be framed differently by another
+ * HTTP parser (request smuggling): obsolete line folding, whitespace before the colon, bare CR,
+ * conflicting Content-Length values and Content-Length combined with Transfer-Encoding.
+ */
+class HttpRequestHeadGuard {
+
+    // Empty lines tolerated before the request line; RFC 9112 section 2.2 asks for at least one
+    Private Static constexpr UInt kMaxLeadingEmptyLines = 2;
+
+    Private HttpRequestLimits limits_;
+    Private HttpLimitCounters* counters_;
+    Private HttpHeadStatus status_;
+    Private Bool inRequestLine_;
+    Private Bool pendingCr_;
+    Private UInt leadingEmptyLines_;
+    Private StdString line_;
+    Private UInt headerCount_;
+    Private Size headerBytes_;
+    Private Size headLength_;
+    Private Bool hasContentLength_;
+    Private ULong contentLength_;
+    Private Bool hasTransferEncoding_;
+    Private Bool chunked_;
+
+    Private HttpHeadStatus Reject(HttpHeadStatus status) {
+        status_ = status;
+        switch (status) {
+            case HttpHeadStatus::RequestLineTooLong: counters_->requestLineTooLong.fetch_add(1, std::memory_order_relaxed); break;
+            case HttpHeadStatus::TooManyHeaders: counters_->tooManyHeaders.fetch_add(1, std::memory_order_relaxed); break;
+            case HttpHeadStatus::HeaderTooLarge: counters_->headerTooLarge.fetch_add(1, std::memory_order_relaxed); break;
+            case HttpHeadStatus::HeadersTooLarge: counters_->headersTooLarge.fetch_add(1, std::memory_order_relaxed); break;
+            case HttpHeadStatus::Malformed: counters_->malformed.fetch_add(1, std::memory_order_relaxed); break;
+            default: break;
+        }
+        return status;
+    }
+
+    Private Static Bool IsTokenChar(char c) {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return true;
+        switch (c) {
+            case '!': case '#': case '$': case '%': case '&': case '\'': case '*':
+            case '+': case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    Private Static Bool EqualsIgnoreCase(CStdString& value, const char* lowerLiteral) {
+        Size i = 0;
+        for (; i < value.length() && lowerLiteral[i] != '\0'; ++i) {
+            if (static_cast<char>(::tolower(static_cast<unsigned char>(value[i]))) != lowerLiteral[i]) return false;
+        }
+        return i == value.length() && lowerLiteral[i] == '\0';
+    }
+
+    /**
+     * Validate "METHOD SP request-target SP HTTP/x.y"
+     */
+    Private Bool CheckRequestLine() const {
+        const Size firstSpace = line_.find(' ');
+        if (firstSpace == 0 || firstSpace == StdString::npos) return false;
+        for (Size i = 0; i < firstSpace; ++i) {
+            if (!IsTokenChar(line_[i])) return false;
+        }
+        const Size secondSpace = line_.find(' ', firstSpace + 1);
+        if (secondSpace == StdString::npos || secondSpace == firstSpace + 1) return false;
+        return line_.compare(secondSpace + 1, 5, "HTTP/") == 0 && line_.find(' ', secondSpace + 1) == StdString::npos;
+    }
+
+    Private HttpHeadStatus CheckHeaderLine() {
+        // Obsolete line folding: a continuation line starting with whitespace
+        if (line_[0] == ' ' || line_[0] == '\t') return Reject(HttpHeadStatus::Malformed);
+
+        const Size colon = line_.find(':');
+        if (colon == StdString::npos || colon == 0) return Reject(HttpHeadStatus::Malformed);
+        for (Size i = 0; i < colon; ++i) {
+            // Also rejects whitespace between the field name and the colon
+            if (!IsTokenChar(line_[i])) return Reject(HttpHeadStatus::Malformed);
+        }
+
+        const StdString name = line_.substr(0, colon);
+        Size valueStart = line_.find_first_not_of(" \t", colon + 1);
+        if (valueStart == StdString::npos) valueStart = line_.length();
+        Size valueEnd = line_.find_last_not_of(" \t");
+        valueEnd = (valueEnd == StdString::npos || valueEnd < valueStart) ? valueStart : valueEnd + 1;
+
+        if (EqualsIgnoreCase(name, "content-length")) {
+            if (valueStart == valueEnd) return Reject(HttpHeadStatus::Malformed);
+            ULong value = 0;
+            for (Size i = valueStart; i < valueEnd; ++i) {
+                const char c = line_[i];
+                if (c < '0' || c > '9') return Reject(HttpHeadStatus::Malformed);
+                const ULong next = value * 10 + static_cast<ULong>(c - '0');
+                if (next / 10 != value) return Reject(HttpHeadStatus::Malformed);
+                value = next;
+            }
+            if (hasContentLength_ && value != contentLength_) return Reject(HttpHeadStatus::Malformed);
+            hasContentLength_ = true;
+            contentLength_ = value;
+        } else if (EqualsIgnoreCase(name, "transfer-encoding")) {
+            hasTransferEncoding_ = true;
+            // Chunked must be the final coding for the body length to be determinable
+            StdString value = line_.substr(valueStart, valueEnd - valueStart);
+            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+            const Size lastComma = value.rfind(',');
+            StdString last = lastComma == StdString::npos ? value : value.substr(lastComma + 1);
+            last.erase(0, last.find_first_not_of(" \t"));
+            chunked_ = last == "chunked";
+            if (!chunked_) return Reject(HttpHeadStatus::Malformed);
+        }
+        return HttpHeadStatus::NeedMore;
+    }
+
+    Private HttpHeadStatus EndOfLine() {
+        if (inRequestLine_) {
+            // Tolerate a few empty lines before the request line (RFC 9112 section 2.2), not an endless stream
+            if (line_.empty()) {
+                if (++leadingEmptyLines_ > kMaxLeadingEmptyLines) return Reject(HttpHeadStatus::Malformed);
+                return HttpHeadStatus::NeedMore;
+            }
+            if (!CheckRequestLine()) return Reject(HttpHeadStatus::Malformed);
+            inRequestLine_ = false;
+            line_.clear();
+            return HttpHeadStatus::NeedMore;
+        }
+        if (line_.empty()) {
+            if (hasContentLength_ && hasTransferEncoding_) return Reject(HttpHeadStatus::Malformed);
+            status_ = HttpHeadStatus::Complete;
+            return status_;
+        }
+        if (++headerCount_ > limits_.maxHeaderCount) return Reject(HttpHeadStatus::TooManyHeaders);
+        const HttpHeadStatus status = CheckHeaderLine();
+        line_.clear();
+        return status;
+    }
+
+    /**
+     * @param limits Limits to enforce
+     * @param counters Rejection counters to update (defaults to HttpLimitCounters::Global())
+     */
+    Public explicit HttpRequestHeadGuard(const HttpRequestLimits& limits = HttpRequestLimits(),
+                                         HttpLimitCounters* counters = nullptr)
+        : limits_(limits), counters_(counters != nullptr ? counters : &HttpLimitCounters::Global()) {
+        Reset();
+    }
+
+    /**
+     * Prepare the guard for the next request on the same connection
+     */
+    Public Void Reset() {
+        status_ = HttpHeadStatus::NeedMore;
+        inRequestLine_ = true;
+        pendingCr_ = false;
+        leadingEmptyLines_ = 0;
+        line_.clear();
+        headerCount_ = 0;
+        headerBytes_ = 0;
+        headLength_ = 0;
+        hasContentLength_ = false;
+        contentLength_ = 0;
+        hasTransferEncoding_ = false;
+        chunked_ = false;
+    }
+
+    /**
+     * Feed the next received bytes
+     * Once Complete or a rejection is returned, further calls return the same status; bytes after
+     * the head (the body or a pipelined request) are not examined.
+     * @return NeedMore, Complete, or the rejection class
+     */
+    Public HttpHeadStatus Feed(const char* data, Size length) {
+        if (status_ != HttpHeadStatus::NeedMore) return status_;
+
+        for (Size i = 0; i < length; ++i) {
+            const char c = data[i];
+            ++headLength_;
+            if (!inRequestLine_ && ++headerBytes_ > limits_.maxTotalHeaderBytes) {
+                return Reject(HttpHeadStatus::HeadersTooLarge);
+            }
+
+            if (pendingCr_) {
+                pendingCr_ = false;
+                if (c != '\n') return Reject(HttpHeadStatus::Malformed);
+            }
+            if (c == '\r') {
+                pendingCr_ = true;
+                continue;
+            }
+            if (c == '\n') {
+                const HttpHeadStatus status = EndOfLine();
+                if (status != HttpHeadStatus::NeedMore) return status;
+                continue;
+            }
+            if (c == '\0') return Reject(HttpHeadStatus::Malformed);
+
+            if (inRequestLine_) {
+                if (line_.length() >= limits_.maxRequestLineLength) return Reject(HttpHeadStatus::RequestLineTooLong);
+            } else if (line_.length() >= limits_.maxHeaderSize) {
+                return Reject(HttpHeadStatus::HeaderTooLarge);
+            }
+            line_.push_back(c);
+        }
+        return status_;
+    }
+
+    Public HttpHeadStatus GetStatus() const {
+        return status_;
+    }
+
+    Public Bool IsRejected() const {
+        return status_ != HttpHeadStatus::NeedMore && status_ != HttpHeadStatus::Complete;
+    }
+
+    /**
+     * Number of bytes making up the head, including the terminating blank line (valid once Complete)
+     */
+    Public Size GetHeadLength() const {
+        return headLength_;
+    }
+
+    /**
+     * Body length announced by Content-Length (valid once Complete and HasContentLength())
+     */
+    Public Bool HasContentLength() const {
+        return hasContentLength_;
+    }
+
+    Public ULong GetContentLength() const {
+        return contentLength_;
+    }
+
+    Public Bool IsChunked() const {
+        return chunked_;
+    }
+
+    /**
+     * HTTP status code to answer a rejected request with (0 if not rejected)
+     */
+    Public UInt GetRejectStatusCode() const {
+        switch (status_) {
+            case HttpHeadStatus::RequestLineTooLong: return 414;
+            case HttpHeadStatus::TooManyHeaders:
+            case HttpHeadStatus::HeaderTooLarge:
+            case HttpHeadStatus::HeadersTooLarge: return 431;
+            case HttpHeadStatus::Malformed: return 400;
+            default: return 0;
+        }
+    }
+
+    /**
+     * Build the response for a rejected request; the connection must be closed after sending it
+     * @return IHttpResponsePtr, or nullptr if the request was not rejected
+     */
+    Public IHttpResponsePtr MakeRejectResponse(CStdString& requestId) const {
+        const UInt statusCode = GetRejectStatusCode();
+        if (statusCode == 0) return nullptr;
+        StdMap<StdString, StdString> headers;
+        headers["Connection"] = "close";
+        headers["Content-Length"] = "0";
+        return make_ptr<SimpleHttpResponse>(requestId, statusCode,
+            SimpleHttpResponse::GetStatusMessageForCode(statusCode), std::move(headers), StdString());
+    }
+};
+
+#endif // HTTPREQUESTHEADGUARD_H
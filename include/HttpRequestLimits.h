@@ -0,0 +1,73 @@
+#ifndef HTTPREQUESTLIMITS_H
+#define HTTPREQUESTLIMITS_H
+
+#include <StandardDefines.h>
+#include <atomic>
+
+/**
+ * Size limits applied to the request line and header block while it is being received
+ * Enforced by HttpRequestHeadGuard before the bytes are buffered.
+ */
+class HttpRequestLimits {
+
+    /**
+     * Maximum length of the request line (method, target, version) in bytes; exceeding it gives 414
+     */
+    Public UInt maxRequestLineLength = 8192;
+
+    /**
+     * Maximum number of header fields; exceeding it gives 431
+     */
+    Public UInt maxHeaderCount = 100;
+
+    /**
+     * Maximum length of a single header line ("Name: value") in bytes; exceeding it gives 431
+     */
+    Public UInt maxHeaderSize = 8192;
+
+    /**
+     * Maximum size of the whole header block after the request line in bytes; exceeding it gives 431
+     */
+    Public UInt maxTotalHeaderBytes = 65536;
+};
+
+/**
+ * Counters for requests rejected by HttpRequestHeadGuard, one per rejection class
+ */
+class HttpLimitCounters {
+
+    Public std::atomic<ULong> requestLineTooLong{0};
+    Public std::atomic<ULong> tooManyHeaders{0};
+    Public std::atomic<ULong> headerTooLarge{0};
+    Public std::atomic<ULong> headersTooLarge{0};
+    Public std::atomic<ULong> malformed{0};
+
+    /**
+     * Total number of rejected requests across all classes
+     */
+    Public ULong GetTotal() const {
+        return requestLineTooLong.load(std::memory_order_relaxed) +
+               tooManyHeaders.load(std::memory_order_relaxed) +
+               headerTooLarge.load(std::memory_order_relaxed) +
+               headersTooLarge.load(std::memory_order_relaxed) +
+               malformed.load(std::memory_order_relaxed);
+    }
+
+    Public Void Reset() {
+        requestLineTooLong.store(0, std::memory_order_relaxed);
+        tooManyHeaders.store(0, std::memory_order_relaxed);
+        headerTooLarge.store(0, std::memory_order_relaxed);
+        headersTooLarge.store(0, std::memory_order_relaxed);
+        malformed.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Process-wide counters used when a guard is not given its own
+     */
+    Public Static HttpLimitCounters& Global() {
+        static HttpLimitCounters counters;
+        return counters;
+    }
+};
+
+#endif // HTTPREQUESTLIMITS_H
@@ -0,0 +1,114 @@
+#ifndef HTTPRESPONSEBUILDER_H
+#define HTTPRESPONSEBUILDER_H
+
+#include <StandardDefines.h>
+#include <utility>
+#include "IHttpResponse.h"
+#include "JsonWriter.h"
+
+/**
+ * Fluent builder for IHttpResponse objects
+ * Collects status, headers and body, then moves them into a SimpleHttpResponse on Build()
+ * so a body built by the handler is never copied on its way into the response.
+ *
+ * Example:
+ *   IHttpResponsePtr response = HttpResponseBuilder(requestId)
+ *       .Status(201)
+ *       .Header("Location", "/api/users/42")
+ *       .Body(std::move(json))
+ *       .Build();
+ */
+class HttpResponseBuilder {
+
+    Private StdString requestId_;
+    Private UInt statusCode_;
+    Private StdString statusMessage_;
+    Private StdMap<StdString, StdString> headers_;
+    Private StdString body_;
+
+    Public explicit HttpResponseBuilder(CStdString& requestId)
+        : requestId_(requestId), statusCode_(200) {
+    }
+
+    Public explicit HttpResponseBuilder(StdString&& requestId)
+        : requestId_(std::move(requestId)), statusCode_(200) {
+    }
+
+    /**
+     * Set the status code; the reason phrase defaults to the standard one for the code
+     */
+    Public HttpResponseBuilder& Status(CUInt statusCode) {
+        statusCode_ = statusCode;
+        return *this;
+    }
+
+    /**
+     * Set the status code with a custom reason phrase
+     */
+    Public HttpResponseBuilder& Status(CUInt statusCode, StdString statusMessage) {
+        statusCode_ = statusCode;
+        statusMessage_ = std::move(statusMessage);
+        return *this;
+    }
+
+    /**
+     * Set a header, replacing any previous value with the same name
+     */
+    Public HttpResponseBuilder& Header(StdString name, StdString value) {
+        headers_[std::move(name)] = std::move(value);
+        return *this;
+    }
+
+    /**
+     * Replace all headers set so far
+     */
+    Public HttpResponseBuilder& Headers(StdMap<StdString, StdString> headers) {
+        headers_ = std::move(headers);
+        return *this;
+    }
+
+    Public HttpResponseBuilder& ContentType(StdString contentType) {
+        headers_["Content-Type"] = std::move(contentType);
+        return *this;
+    }
+
+    /**
+     * Set the body; pass an rvalue (std::move) to hand the buffer over without copying
+     */
+    Public HttpResponseBuilder& Body(StdString body) {
+        body_ = std::move(body);
+        return *this;
+    }
+
+    /**
+     * Set a JSON body serialized with JsonWriter, taking over its buffer
+     */
+    Public HttpResponseBuilder& Json(JsonWriter&& json) {
+        headers_["Content-Type"] = "application/json";
+        body_ = json.Release();
+        return *this;
+    }
+
+    /**
+     * Build the response, moving the collected parts into it
+     * The builder is left empty (status 200, no headers, no body) afterwards.
+     * @return IHttpResponsePtr (shared_ptr), or nullptr if the request ID is empty
+     */
+    Public IHttpResponsePtr Build() {
+        if (requestId_.empty()) {
+            return nullptr;
+        }
+        if (statusMessage_.empty()) {
+            statusMessage_ = SimpleHttpResponse::GetStatusMessageForCode(statusCode_);
+        }
+        IHttpResponsePtr response = make_ptr<SimpleHttpResponse>(
+            requestId_, statusCode_, std::move(statusMessage_), std::move(headers_), std::move(body_));
+        statusCode_ = 200;
+        statusMessage_.clear();
+        headers_.clear();
+        body_.clear();
+        return response;
+    }
+};
+
+#endif // HTTPRESPONSEBUILDER_H
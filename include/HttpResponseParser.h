@@ -0,0 +1,504 @@
+#ifndef HTTPRESPONSEPARSER_H
+#define HTTPRESPONSEPARSER_H
+
+#include <StandardDefines.h>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include "IHttpResponse.h"
+#include "SimdScan.h"
+
+/**
+ * Result of feeding bytes to an HttpResponseParser
+ */
+enum class HttpResponseParseStatus {
+    NeedMore,   // Response not complete yet, keep reading (or call Finish() at end of stream)
+    Complete,   // A full response is buffered; take it with TakeResponse()
+    Error       // Malformed response; close the connection
+};
+
+/**
+ * Incremental, zero-copy parser for HTTP/1.x responses
+ * Bytes can arrive split at any point; they are received straight into the parser's buffer
+ * (PrepareWrite() / Commit()) and parsed in place: the status line, header fields and
+ * Content-Length or close-delimited bodies are kept as offsets into that buffer, so nothing is
+ * copied until TakeResponse() builds the IHttpResponse (or at all, when only the views are used).
+ * Chunked bodies are decoded as they arrive. Responses to HEAD (see ExpectNoBody()), 1xx, 204
+ * and 304 have no body; a body without Content-Length or chunked coding ends at Finish().
+ * Bytes after a complete response (the next pipelined response) stay buffered for the next parse.
+ *
+ *   HttpResponseParser parser;
+ *   HttpResponseParseStatus status = HttpResponseParseStatus::NeedMore;
+ *   while (status == HttpResponseParseStatus::NeedMore) {
+ *       char* space = parser.PrepareWrite(16 * 1024);
+ *       ssize_t received = recv(fd, space, 16 * 1024, 0);
+ *       status = received > 0 ? parser.Commit(received) : parser.Finish();
+ *   }
+ *   IHttpResponsePtr response = parser.TakeResponse(requestId);
+ */
+class HttpResponseParser {
+
+    Public Static constexpr Size kMaxHeadBytes = 64 * 1024;
+
+    Private enum class State { StatusLine, Headers, Body, BodyUntilClose, ChunkSize, ChunkData, ChunkDataEnd, Trailers, Complete, Error };
+
+    /**
+     * A header field as offsets relative to the start of the current message
+     */
+    Private class Field {
+        Public Size nameOffset;
+        Public Size nameLength;
+        Public Size valueOffset;
+        Public Size valueLength;
+    };
+
+    Private std::unique_ptr<char[]> data_;
+    Private Size capacity_;
+    // data_[begin_, filled_) holds the current message and anything received after it
+    Private Size begin_;
+    Private Size filled_;
+    // Parse position relative to begin_
+    Private Size position_;
+    Private State state_;
+    Private Bool expectNoBody_;
+    Private Bool keepRaw_;
+    Private Size versionLength_;
+    Private UInt statusCode_;
+    Private Size reasonOffset_;
+    Private Size reasonLength_;
+    Private StdVector<Field> fields_;
+    Private Size bodyOffset_;
+    Private ULong remaining_;
+    Private Bool chunked_;
+    Private Bool hasContentLength_;
+    Private ULong contentLength_;
+    Private Bool closeDelimited_;
+    // Decoded chunked body; other bodies stay in the buffer
+    Private StdString decoded_;
+
+    Private Static Bool EqualsIgnoreCase(std::string_view value, const char* lowerLiteral) {
+        Size i = 0;
+        for (; i < value.length() && lowerLiteral[i] != '\0'; ++i) {
+            if (static_cast<char>(::tolower(static_cast<unsigned char>(value[i]))) != lowerLiteral[i]) return false;
+        }
+        return i == value.length() && lowerLiteral[i] == '\0';
+    }
+
+    Private Static Bool ContainsIgnoreCase(std::string_view value, const char* lowerToken) {
+        const Size tokenLength = std::strlen(lowerToken);
+        for (Size start = 0; start + tokenLength <= value.length(); ++start) {
+            if (EqualsIgnoreCase(value.substr(start, tokenLength), lowerToken)) return true;
+        }
+        return false;
+    }
+
+    Private const char* Message() const {
+        return data_.get() + begin_;
+    }
+
+    Private Size Available() const {
+        return filled_ - begin_;
+    }
+
+    Private std::string_view View(Size offset, Size length) const {
+        return std::string_view(Message() + offset, length);
+    }
+
+    Private Void ResetMessage() {
+        position_ = 0;
+        state_ = State::StatusLine;
+        versionLength_ = 0;
+        statusCode_ = 0;
+        reasonOffset_ = 0;
+        reasonLength_ = 0;
+        fields_.clear();
+        bodyOffset_ = 0;
+        remaining_ = 0;
+        chunked_ = false;
+        hasContentLength_ = false;
+        contentLength_ = 0;
+        closeDelimited_ = false;
+        decoded_.clear();
+    }
+
+    Private HttpResponseParseStatus Fail() {
+        state_ = State::Error;
+        return HttpResponseParseStatus::Error;
+    }
+
+    Private HttpResponseParseStatus Done() {
+        state_ = State::Complete;
+        return HttpResponseParseStatus::Complete;
+    }
+
+    /**
+     * Next LF-terminated line at position_ (without CR LF), located with SimdScan
+     * @return false if the line is not complete yet
+     */
+    Private Bool NextLine(Size& lineOffset, Size& lineLength) {
+        const Size available = Available() - position_;
+        const Size found = SimdScan::FindByte(Message() + position_, available, '\n');
+        if (found == available) return false;
+        lineOffset = position_;
+        lineLength = found;
+        if (lineLength > 0 && Message()[lineOffset + lineLength - 1] == '\r') --lineLength;
+        position_ += found + 1;
+        return true;
+    }
+
+    /**
+     * "HTTP/x.y SP 3DIGIT [SP reason]"
+     */
+    Private Bool ParseStatusLine(Size offset, Size length) {
+        const std::string_view line = View(offset, length);
+        if (line.compare(0, 5, "HTTP/") != 0) return false;
+        const Size space = line.find(' ');
+        if (space == std::string_view::npos || line.length() < space + 4) return false;
+        UInt code = 0;
+        for (Size i = space + 1; i < space + 4; ++i) {
+            if (line[i] < '0' || line[i] > '9') return false;
+            code = code * 10 + static_cast<UInt>(line[i] - '0');
+        }
+        if (line.length() > space + 4 && line[space + 4] != ' ') return false;
+        versionLength_ = space;
+        statusCode_ = code;
+        const Bool hasReason = line.length() > space + 5;
+        reasonOffset_ = offset + (hasReason ? space + 5 : line.length());
+        reasonLength_ = hasReason ? line.length() - space - 5 : 0;
+        return true;
+    }
+
+    Private Bool ParseHeaderLine(Size offset, Size length) {
+        const char* line = Message() + offset;
+        const void* colonPointer = std::memchr(line, ':', length);
+        if (colonPointer == nullptr || line[0] == ' ' || line[0] == '\t') return false;
+        const Size colon = static_cast<Size>(static_cast<const char*>(colonPointer) - line);
+        if (colon == 0) return false;
+        Size valueStart = colon + 1;
+        while (valueStart < length && (line[valueStart] == ' ' || line[valueStart] == '\t')) ++valueStart;
+        Size valueEnd = length;
+        while (valueEnd > valueStart && (line[valueEnd - 1] == ' ' || line[valueEnd - 1] == '\t')) --valueEnd;
+
+        const std::string_view name(line, colon);
+        const std::string_view value(line + valueStart, valueEnd - valueStart);
+        if (EqualsIgnoreCase(name, "content-length")) {
+            if (value.empty()) return false;
+            ULong parsed = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9') return false;
+                const ULong next = parsed * 10 + static_cast<ULong>(c - '0');
+                if (next / 10 != parsed) return false;
+                parsed = next;
+            }
+            if (hasContentLength_ && parsed != contentLength_) return false;
+            hasContentLength_ = true;
+            contentLength_ = parsed;
+        } else if (EqualsIgnoreCase(name, "transfer-encoding")) {
+            chunked_ = ContainsIgnoreCase(value, "chunked");
+            if (!chunked_) return false;
+        }
+        fields_.push_back(Field{ offset, colon, offset + valueStart, valueEnd - valueStart });
+        return true;
+    }
+
+    /**
+     * Decide how the body is framed once the blank line after the headers is seen
+     */
+    Private HttpResponseParseStatus EndOfHead() {
+        bodyOffset_ = position_;
+        if (expectNoBody_ || (statusCode_ >= 100 && statusCode_ < 200) || statusCode_ == 204 || statusCode_ == 304) {
+            return Done();
+        }
+        if (chunked_) {
+            // Transfer-Encoding overrides Content-Length (RFC 9112 section 6.3)
+            state_ = State::ChunkSize;
+        } else if (hasContentLength_) {
+            remaining_ = contentLength_;
+            state_ = State::Body;
+        } else {
+            closeDelimited_ = true;
+            state_ = State::BodyUntilClose;
+        }
+        return HttpResponseParseStatus::NeedMore;
+    }
+
+    Private HttpResponseParseStatus Advance() {
+        Size lineOffset = 0;
+        Size lineLength = 0;
+        while (true) {
+            switch (state_) {
+                case State::StatusLine:
+                case State::Headers: {
+                    if (!NextLine(lineOffset, lineLength)) {
+                        if (Available() > kMaxHeadBytes) return Fail();
+                        return HttpResponseParseStatus::NeedMore;
+                    }
+                    if (position_ > kMaxHeadBytes) return Fail();
+                    if (state_ == State::StatusLine) {
+                        if (!ParseStatusLine(lineOffset, lineLength)) return Fail();
+                        state_ = State::Headers;
+                    } else if (lineLength == 0) {
+                        const HttpResponseParseStatus status = EndOfHead();
+                        if (status != HttpResponseParseStatus::NeedMore) return status;
+                    } else if (!ParseHeaderLine(lineOffset, lineLength)) {
+                        return Fail();
+                    }
+                    break;
+                }
+                case State::Body: {
+                    // The body stays in place; only the position moves
+                    const Size available = Available() - position_;
+                    const Size take = remaining_ < available ? static_cast<Size>(remaining_) : available;
+                    position_ += take;
+                    remaining_ -= take;
+                    if (remaining_ > 0) return HttpResponseParseStatus::NeedMore;
+                    return Done();
+                }
+                case State::BodyUntilClose:
+                    position_ = Available();
+                    return HttpResponseParseStatus::NeedMore;
+                case State::ChunkSize: {
+                    if (!NextLine(lineOffset, lineLength)) return HttpResponseParseStatus::NeedMore;
+                    // Chunk extensions after ';' are ignored
+                    const std::string_view line = View(lineOffset, lineLength);
+                    const Size end = line.find_first_of("; \t");
+                    const Size digits = end == std::string_view::npos ? line.length() : end;
+                    if (digits == 0 || digits > 15) return Fail();
+                    ULong size = 0;
+                    for (Size i = 0; i < digits; ++i) {
+                        const char c = line[i];
+                        int value = -1;
+                        if (c >= '0' && c <= '9') value = c - '0';
+                        else if (c >= 'a' && c <= 'f') value = c - 'a' + 10;
+                        else if (c >= 'A' && c <= 'F') value = c - 'A' + 10;
+                        if (value < 0) return Fail();
+                        size = size * 16 + static_cast<ULong>(value);
+                    }
+                    remaining_ = size;
+                    state_ = size == 0 ? State::Trailers : State::ChunkData;
+                    break;
+                }
+                case State::ChunkData: {
+                    const Size available = Available() - position_;
+                    const Size take = remaining_ < available ? static_cast<Size>(remaining_) : available;
+                    decoded_.append(Message() + position_, take);
+                    position_ += take;
+                    remaining_ -= take;
+                    if (remaining_ > 0) return HttpResponseParseStatus::NeedMore;
+                    state_ = State::ChunkDataEnd;
+                    break;
+                }
+                case State::ChunkDataEnd: {
+                    if (!NextLine(lineOffset, lineLength)) return HttpResponseParseStatus::NeedMore;
+                    if (lineLength != 0) return Fail();
+                    state_ = State::ChunkSize;
+                    break;
+                }
+                case State::Trailers: {
+                    if (!NextLine(lineOffset, lineLength)) return HttpResponseParseStatus::NeedMore;
+                    // Trailer fields are discarded
+                    if (lineLength == 0) return Done();
+                    break;
+                }
+                case State::Complete:
+                    return HttpResponseParseStatus::Complete;
+                case State::Error:
+                    return HttpResponseParseStatus::Error;
+            }
+        }
+    }
+
+    /**
+     * @param keepRaw Copy the received bytes of each response into GetRawResponse()
+     */
+    Public explicit HttpResponseParser(Bool keepRaw = true)
+        : capacity_(0), begin_(0), filled_(0), expectNoBody_(false), keepRaw_(keepRaw) {
+        ResetMessage();
+    }
+
+    HttpResponseParser(const HttpResponseParser&) = delete;
+    HttpResponseParser& operator=(const HttpResponseParser&) = delete;
+
+    /**
+     * Space for at least minimum more bytes at the end of the buffer, to receive into directly
+     * Follow with Commit() for the number of bytes written. Invalidates views from GetHeader()/GetBodyView().
+     */
+    Public char* PrepareWrite(Size minimum) {
+        if (capacity_ - filled_ >= minimum) return data_.get() + filled_;
+        if (begin_ > 0) {
+            // Drop consumed responses; offsets are relative to begin_ and stay valid
+            std::memmove(data_.get(), data_.get() + begin_, filled_ - begin_);
+            filled_ -= begin_;
+            begin_ = 0;
+        }
+        if (capacity_ - filled_ < minimum) {
+            Size capacity = capacity_ < 4096 ? 4096 : capacity_ * 2;
+            while (capacity - filled_ < minimum) capacity *= 2;
+            std::unique_ptr<char[]> data(new char[capacity]);
+            if (filled_ > 0) std::memcpy(data.get(), data_.get(), filled_);
+            data_ = std::move(data);
+            capacity_ = capacity;
+        }
+        return data_.get() + filled_;
+    }
+
+    /**
+     * Account for bytes written after PrepareWrite() and parse as far as possible
+     */
+    Public HttpResponseParseStatus Commit(Size length) {
+        filled_ += length;
+        return Advance();
+    }
+
+    /**
+     * Copy received bytes in and parse as far as possible
+     * Once Complete is returned, further calls only buffer the bytes until TakeResponse().
+     */
+    Public HttpResponseParseStatus Feed(const char* data, Size length) {
+        if (length > 0) std::memcpy(PrepareWrite(length), data, length);
+        return Commit(length);
+    }
+
+    /**
+     * Parse the next response from already buffered bytes (after TakeResponse() on a pipelined stream)
+     */
+    Public HttpResponseParseStatus Parse() {
+        return Advance();
+    }
+
+    /**
+     * The peer closed the connection: completes a close-delimited body
+     * @return Complete if a full response is buffered, Error if the stream ended mid-response
+     */
+    Public HttpResponseParseStatus Finish() {
+        const HttpResponseParseStatus status = Advance();
+        if (status != HttpResponseParseStatus::NeedMore) return status;
+        if (state_ == State::BodyUntilClose) return Done();
+        return Fail();
+    }
+
+    /**
+     * The response being parsed answers a HEAD request: it has headers only
+     * Applies to the current response; reset by TakeResponse().
+     */
+    Public Void ExpectNoBody(Bool noBody = true) {
+        expectNoBody_ = noBody;
+    }
+
+    /**
+     * Status code of the current response, 0 before the status line has been parsed
+     */
+    Public UInt GetStatusCode() const {
+        return statusCode_;
+    }
+
+    Public Bool IsComplete() const {
+        return state_ == State::Complete;
+    }
+
+    /**
+     * First value of a header of the current response (case-insensitive), without copying
+     * Valid until the next PrepareWrite(), Feed() or TakeResponse().
+     */
+    Public std::string_view GetHeader(std::string_view name) const {
+        for (const Field& field : fields_) {
+            const std::string_view fieldName = View(field.nameOffset, field.nameLength);
+            if (fieldName.length() != name.length()) continue;
+            Bool equal = true;
+            for (Size i = 0; i < name.length() && equal; ++i) {
+                equal = ::tolower(static_cast<unsigned char>(fieldName[i])) == ::tolower(static_cast<unsigned char>(name[i]));
+            }
+            if (equal) return View(field.valueOffset, field.valueLength);
+        }
+        return std::string_view();
+    }
+
+    /**
+     * Body of the complete response (decoded if it was chunked), without copying
+     * Valid until the next PrepareWrite(), Feed() or TakeResponse().
+     */
+    Public std::string_view GetBodyView() const {
+        if (state_ != State::Complete) return std::string_view();
+        if (chunked_) return std::string_view(decoded_);
+        return View(bodyOffset_, position_ - bodyOffset_);
+    }
+
+    /**
+     * Whether the connection can carry another request after the current response
+     * HTTP/1.1 defaults to keep-alive unless "Connection: close"; HTTP/1.0 requires
+     * "Connection: keep-alive". Never after a close-delimited body.
+     */
+    Public Bool IsKeepAlive() const {
+        if (closeDelimited_) return false;
+        for (const Field& field : fields_) {
+            if (!EqualsIgnoreCase(View(field.nameOffset, field.nameLength), "connection")) continue;
+            const std::string_view value = View(field.valueOffset, field.valueLength);
+            if (ContainsIgnoreCase(value, "close")) return false;
+            if (ContainsIgnoreCase(value, "keep-alive")) return true;
+        }
+        return View(0, versionLength_) != "HTTP/1.0";
+    }
+
+    /**
+     * Hand over the completed response and start parsing the next one from the remaining bytes
+     * A decoded chunked body replaces the chunked framing: Transfer-Encoding is dropped and
+     * Content-Length set. The raw response holds the bytes exactly as received.
+     * @return The response, or nullptr if no complete response is buffered
+     */
+    Public IHttpResponsePtr TakeResponse(CStdString& requestId) {
+        if (state_ != State::Complete) return nullptr;
+        const Bool dechunked = chunked_ && position_ > bodyOffset_;
+        StdMap<StdString, StdString> headers;
+        StdMap<StdString, StdString> setCookies;
+        for (const Field& field : fields_) {
+            const std::string_view name = View(field.nameOffset, field.nameLength);
+            const std::string_view value = View(field.valueOffset, field.valueLength);
+            if (EqualsIgnoreCase(name, "set-cookie")) {
+                // Set-Cookie fields cannot be combined into one value; kept by cookie name
+                const Size equals = value.find('=');
+                setCookies[StdString(value.substr(0, equals == std::string_view::npos ? 0 : equals))] = StdString(value);
+                continue;
+            }
+            if (dechunked && (EqualsIgnoreCase(name, "transfer-encoding") || EqualsIgnoreCase(name, "content-length"))) continue;
+            auto inserted = headers.emplace(StdString(name), StdString(value));
+            if (!inserted.second) {
+                inserted.first->second += ", ";
+                inserted.first->second.append(value.data(), value.length());
+            }
+        }
+        if (dechunked) headers["Content-Length"] = std::to_string(decoded_.length());
+
+        StdString body = chunked_ ? std::move(decoded_) : StdString(GetBodyView());
+        IHttpResponsePtr response = std::make_shared<SimpleHttpResponse>(
+            requestId, StdString(View(0, versionLength_)), statusCode_, StdString(View(reasonOffset_, reasonLength_)),
+            std::move(headers), std::move(body), std::move(setCookies),
+            keepRaw_ ? StdString(Message(), position_) : StdString());
+
+        begin_ += position_;
+        if (begin_ == filled_) begin_ = filled_ = 0;
+        expectNoBody_ = false;
+        ResetMessage();
+        return response;
+    }
+
+    /**
+     * Bytes received after the current response (e.g. the start of the next pipelined response)
+     */
+    Public Bool HasBufferedData() const {
+        return position_ < Available();
+    }
+
+    /**
+     * Discard all state, e.g. before reusing the parser for another connection
+     */
+    Public Void Reset() {
+        begin_ = 0;
+        filled_ = 0;
+        expectNoBody_ = false;
+        ResetMessage();
+    }
+};
+
+#endif // HTTPRESPONSEPARSER_H
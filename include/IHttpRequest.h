@@ -3,6 +3,9 @@
 
 #include <StandardDefines.h>
 #include "HttpMethod.h"
+#include "JsonView.h"
+#include "ClientAddress.h"
+#include "BasicAuthCredentials.h"
 
 /**
  * Interface representing a complete HTTP request
@@ -90,6 +93,14 @@ class IHttpRequest {
      */
     Public Virtual StdString GetBasicAuth() const = 0;
     
+    /**
+     * Get the decoded Basic Auth user and password
+     * @return Credentials; IsValid() is false if the header is missing or malformed
+     */
+    Public Virtual BasicAuthCredentials GetBasicAuthCredentials() const {
+        return BasicAuthCredentials(GetBasicAuth());
+    }
+    
     /**
      * Get API key/token from custom header (e.g., "X-API-Key")
      */
@@ -146,6 +157,16 @@ class IHttpRequest {
      */
     Public Virtual UInt GetClientPort() const = 0;
     
+    /**
+     * Get the client's address in binary form, without formatting it
+     * Default implementation parses GetClientIp(); implementations storing the address override it
+     */
+    Public Virtual ClientAddress GetClientAddress() const {
+        ClientAddress address;
+        ClientAddress::Parse(GetClientIp(), static_cast<std::uint16_t>(GetClientPort()), address);
+        return address;
+    }
+    
     /**
      * Get the User-Agent header value
      */
@@ -186,6 +207,17 @@ class IHttpRequest {
      */
     Public Virtual Bool IsJson() const = 0;
     
+    /**
+     * Get an on-demand JSON view of the request body
+     * The body is indexed by the calling thread's reusable JsonParser; values are decoded only when
+     * accessed. The view is valid while this request is alive and until the next GetJson() call on
+     * the same thread.
+     * @return Root JSON value, or an Invalid view if the body is not well-formed JSON
+     */
+    Public Virtual JsonValue GetJson() const {
+        return JsonParser::ThreadLocal().Index(GetBody());
+    }
+    
     /**
      * Check if Content-Type is form data
      */
@@ -215,6 +247,14 @@ class IHttpRequest {
      * @return IHttpRequestPtr (shared_ptr), or nullptr if parsing fails
      */
     Static inline IHttpRequestPtr GetRequest(CStdString& requestId, CStdString& rawRequest);
+    
+    /**
+     * Parse raw HTTP request string, taking ownership of the buffer
+     * @param requestId The unique request ID (GUID) for this request
+     * @param rawRequest The raw HTTP request string, moved into the request object
+     * @return IHttpRequestPtr (shared_ptr), or nullptr if parsing fails
+     */
+    Static inline IHttpRequestPtr GetRequest(CStdString& requestId, StdString&& rawRequest);
 };
 
 // Include SimpleHttpRequest for inline implementation
@@ -228,5 +268,12 @@ inline IHttpRequestPtr IHttpRequest::GetRequest(CStdString& requestId, CStdStrin
     return make_ptr<SimpleHttpRequest>(requestId, rawRequest);
 }
 
+inline IHttpRequestPtr IHttpRequest::GetRequest(CStdString& requestId, StdString&& rawRequest) {
+    if (rawRequest.empty()) {
+        return nullptr;
+    }
+    return make_ptr<SimpleHttpRequest>(requestId, std::move(rawRequest));
+}
+
 #endif // IHTTPREQUEST_H
 
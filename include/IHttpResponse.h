@@ -242,6 +242,14 @@ class IHttpResponse {
      * @return IHttpResponsePtr (shared_ptr), or nullptr if requestId is empty
      */
     Static inline IHttpResponsePtr GetResponse(CStdString& requestId, CStdString& body);
+    
+    /**
+     * Create an IHttpResponse object, taking ownership of the response body
+     * @param requestId The unique request ID (GUID) for this response
+     * @param body The response body content, moved into the response object
+     * @return IHttpResponsePtr (shared_ptr), or nullptr if requestId is empty
+     */
+    Static inline IHttpResponsePtr GetResponse(CStdString& requestId, StdString&& body);
 };
 
 // Include SimpleHttpResponse for inline implementation
@@ -255,5 +263,12 @@ inline IHttpResponsePtr IHttpResponse::GetResponse(CStdString& requestId, CStdSt
     return make_ptr<SimpleHttpResponse>(requestId, body);
 }
 
+inline IHttpResponsePtr IHttpResponse::GetResponse(CStdString& requestId, StdString&& body) {
+    if (requestId.empty()) {
+        return nullptr;
+    }
+    return make_ptr<SimpleHttpResponse>(requestId, std::move(body));
+}
+
 #endif // IHTTPRESPONSE_H
 
@@ -3,6 +3,14 @@
 
 #include <StandardDefines.h>
 #include "ServerType.h"
+#include "HttpRequestLimits.h"
+#include "ServerDrain.h"
+#include "ReactorPlacement.h"
+#include "BusyPoll.h"
+#include "SocketOptions.h"
+#include "ClientAddress.h"
+#include "TrafficCapture.h"
+#include <future>
 
 // Forward declaration and pointer types
 DefineStandardPointers(IHttpRequest)
@@ -30,16 +38,61 @@ class IServer {
     Public Virtual Bool Start(CUInt port = DEFAULT_SERVER_PORT) = 0;
     
     /**
-     * Stop the server and release resources
+     * Stop the server immediately and release resources
+     * Open connections are closed even if a response is being written; use StopAsync() to drain.
      */
     Public Virtual Void Stop() = 0;
     
+    /**
+     * Stop the server gracefully
+     * Stops accepting connections, sends "Connection: close" on the next response of every keep-alive
+     * connection, completes queued and in-flight requests until the deadline, then closes everything.
+     * Implementations usually delegate to ServerDrain::Drain(); the default simply calls Stop().
+     * @param deadlineMs Maximum time in milliseconds to wait for in-flight requests
+     * @return Future resolving to true if all in-flight requests completed before the deadline
+     */
+    Public Virtual std::future<Bool> StopAsync(CUInt deadlineMs) {
+        (void)deadlineMs;
+        Stop();
+        std::promise<Bool> stopped;
+        stopped.set_value(true);
+        return stopped.get_future();
+    }
+    
+    /**
+     * Get the progress of a graceful stop started with StopAsync()
+     * @return Drain counters (all zero if the implementation does not drain)
+     */
+    Public Virtual DrainProgress GetDrainProgress() const {
+        return DrainProgress();
+    }
+    
     /**
      * Check if the server is currently running
      * @return true if server is running, false otherwise
      */
     Public Virtual Bool IsRunning() const = 0;
     
+    // ========== Listening Socket Handoff ==========
+    
+    /**
+     * Get the listening socket descriptors of a running server (see ListenerHandoff)
+     * @return Listening descriptors still owned by the server, empty if unsupported or not running
+     */
+    Public Virtual StdVector<int> GetListeningSockets() const {
+        return StdVector<int>();
+    }
+    
+    /**
+     * Adopt already bound and listening sockets, to be used by the next Start() instead of binding
+     * @param sockets Listening descriptors; ownership passes to the server on success
+     * @return true if adopted, false if the server is running or does not support adoption
+     */
+    Public Virtual Bool AdoptListeningSockets(const StdVector<int>& sockets) {
+        (void)sockets;
+        return false;
+    }
+    
     // ========== Port Configuration ==========
     
     /**
@@ -93,6 +146,16 @@ class IServer {
      */
     Public Virtual UInt GetLastClientPort() const = 0;
     
+    /**
+     * Get the last client's address in binary form, avoiding the string copy of GetLastClientIp()
+     * @return Client address, empty (IsValid() == false) if no client
+     */
+    Public Virtual ClientAddress GetLastClientAddress() const {
+        ClientAddress address;
+        ClientAddress::Parse(GetLastClientIp(), static_cast<std::uint16_t>(GetLastClientPort()), address);
+        return address;
+    }
+    
     // ========== Server Statistics ==========
     
     /**
@@ -140,6 +203,96 @@ class IServer {
      */
     Public Virtual Bool SetReceiveTimeout(CUInt timeoutMs) = 0;
     
+    /**
+     * Get the request line/header limits enforced while receiving
+     * @return Limits in effect (library defaults if the implementation does not enforce any)
+     */
+    Public Virtual HttpRequestLimits GetRequestLimits() const {
+        return HttpRequestLimits();
+    }
+    
+    /**
+     * Set the request line/header limits enforced while receiving (see HttpRequestHeadGuard)
+     * @param limits Limits to enforce
+     * @return true if the limits were applied, false if the server is running or does not support limits
+     */
+    Public Virtual Bool SetRequestLimits(const HttpRequestLimits& limits) {
+        (void)limits;
+        return false;
+    }
+    
+    /**
+     * Get the counters of requests rejected by the header limits
+     * @return Counters owned by the server, or the process-wide counters by default
+     */
+    Public Virtual const HttpLimitCounters& GetLimitCounters() const {
+        return HttpLimitCounters::Global();
+    }
+    
+    /**
+     * Set CPU/NUMA placement of the reactor shards (only works if server is not running)
+     * @param placement Per-shard CPU sets and NUMA nodes, plus SO_INCOMING_CPU steering
+     * @return true if applied, false if the server is running or is not sharded
+     */
+    Public Virtual Bool SetReactorPlacement(const ReactorPlacement& placement) {
+        (void)placement;
+        return false;
+    }
+    
+    /**
+     * Select busy-poll (spinning) or normal blocking waits for this server's reactor
+     * @param config Busy-poll settings; config.enabled = false restores blocking waits
+     * @return true if applied, false if the server does not support busy polling
+     */
+    Public Virtual Bool SetBusyPoll(const BusyPollConfig& config) {
+        (void)config;
+        return false;
+    }
+    
+    /**
+     * Send responses of at least thresholdBytes with MSG_ZEROCOPY (see ZeroCopySender)
+     * @param thresholdBytes Minimum response size for zero-copy sends; 0 always copies
+     * @return true if applied, false if the server does not support zero-copy sends
+     */
+    Public Virtual Bool SetZeroCopyThreshold(Size thresholdBytes) {
+        (void)thresholdBytes;
+        return false;
+    }
+    
+    /**
+     * Socket options applied to the listener in Start() and to every accepted connection
+     * Takes effect at the next Start() for listener options.
+     * @param options Options profile, e.g. SocketOptions::Latency()
+     * @return true if accepted, false if the server does not support socket tuning
+     */
+    Public Virtual Bool SetSocketOptions(const SocketOptions& options) {
+        (void)options;
+        return false;
+    }
+    
+    /**
+     * Expect a PROXY protocol v1/v2 preamble on every accepted connection (see ProxyProtocol)
+     * Client addresses then report the original client behind the load balancer.
+     * @param enabled true when the server sits behind a load balancer sending PROXY preambles
+     * @return true if applied, false if the server does not support the PROXY protocol
+     */
+    Public Virtual Bool SetProxyProtocol(Bool enabled) {
+        (void)enabled;
+        return false;
+    }
+    
+    /**
+     * Record the raw bytes of incoming requests into a capture log (see TrafficCapture)
+     * The server calls capture->Record() with each request as read from the socket; sampling is
+     * applied by the capture. The capture must outlive its attachment.
+     * @param capture Open capture, or nullptr to stop capturing
+     * @return true if applied, false if the server does not support traffic capture
+     */
+    Public Virtual Bool SetTrafficCapture(TrafficCapture* capture) {
+        (void)capture;
+        return false;
+    }
+    
     // ========== Server Type Information ==========
     
     /**
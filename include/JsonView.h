@@ -0,0 +1,603 @@
+#ifndef JSONVIEW_H
+#define JSONVIEW_H
+
+#include <StandardDefines.h>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include "SimdScan.h"
+
+class JsonParser;
+
+/**
+ * Kind of value a JsonValue refers to
+ */
+enum class JsonType {
+    Null,
+    Boolean,
+    Number,
+    String,
+    Array,
+    Object,
+    Invalid
+};
+
+/**
+ * On-demand view of one value inside a document indexed by JsonParser
+ * Nothing is converted until the handler asks for it: looking up a key skips sibling
+ * values in O(1) via the structural index, and strings/numbers are decoded only on Get*().
+ * A view stays valid until its parser indexes another document.
+ * Lookups on the wrong type or on a missing key return an Invalid view instead of throwing.
+ */
+class JsonValue {
+
+    Private const JsonParser* parser_;
+    // Position of this value in the parser's structural index
+    Private UInt token_;
+
+    Private inline char TokenChar(UInt token) const;
+    Private inline UInt TokenCount() const;
+    Private inline UInt SkipValue(UInt token) const;
+    Private inline std::string_view ScalarText() const;
+    Private inline std::string_view StringContent(UInt token) const;
+
+    Public JsonValue() : parser_(nullptr), token_(0) {}
+    Public JsonValue(const JsonParser* parser, UInt token) : parser_(parser), token_(token) {}
+
+    Public inline JsonType GetType() const;
+
+    Public Bool IsValid() const { return GetType() != JsonType::Invalid; }
+    Public Bool IsNull() const { return GetType() == JsonType::Null; }
+    Public Bool IsObject() const { return GetType() == JsonType::Object; }
+    Public Bool IsArray() const { return GetType() == JsonType::Array; }
+    Public Bool IsString() const { return GetType() == JsonType::String; }
+    Public Bool IsNumber() const { return GetType() == JsonType::Number; }
+    Public Bool IsBool() const { return GetType() == JsonType::Boolean; }
+
+    // ========== Navigation ==========
+
+    /**
+     * Look up an object member by key (keys are compared after unescaping only if they contain escapes)
+     * @return The member value, or an Invalid view if this is not an object or the key is missing
+     */
+    Public inline JsonValue operator[](std::string_view key) const;
+
+    Public JsonValue operator[](const char* key) const {
+        return (*this)[std::string_view(key)];
+    }
+
+    /**
+     * Get an array element by position
+     * @return The element, or an Invalid view if this is not an array or index is out of range
+     */
+    Public inline JsonValue operator[](Size index) const;
+
+    Public JsonValue operator[](int index) const {
+        return index < 0 ? JsonValue() : (*this)[static_cast<Size>(index)];
+    }
+
+    /**
+     * Number of members (object) or elements (array), 0 for other types
+     */
+    Public inline Size GetSize() const;
+
+    /**
+     * Call fn(key, value) for every member of an object
+     * The key is the raw (still escaped) text between the quotes.
+     */
+    Public template<typename Fn>
+    Void ForEachField(Fn&& fn) const {
+        if (GetType() != JsonType::Object) return;
+        UInt token = token_ + 1;
+        while (token + 1 < TokenCount() && TokenChar(token) == '"' && TokenChar(token + 1) == ':') {
+            fn(StringContent(token), JsonValue(parser_, token + 2));
+            token = SkipValue(token + 2);
+            if (token >= TokenCount() || TokenChar(token) != ',') break;
+            ++token;
+        }
+    }
+
+    /**
+     * Call fn(value) for every element of an array
+     */
+    Public template<typename Fn>
+    Void ForEachElement(Fn&& fn) const {
+        if (GetType() != JsonType::Array) return;
+        UInt token = token_ + 1;
+        if (token < TokenCount() && TokenChar(token) == ']') return;
+        while (token < TokenCount()) {
+            fn(JsonValue(parser_, token));
+            token = SkipValue(token);
+            if (token >= TokenCount() || TokenChar(token) != ',') break;
+            ++token;
+        }
+    }
+
+    // ========== Scalar Access ==========
+
+    /**
+     * Get a string value, unescaped
+     * @return The string, or defaultValue if this is not a string
+     */
+    Public inline StdString GetString(CStdString& defaultValue = StdString()) const;
+
+    /**
+     * Get the raw text of a string value without unescaping (no allocation)
+     * Equal to the decoded value when the string contains no backslashes.
+     */
+    Public std::string_view GetRawString() const {
+        return GetType() == JsonType::String ? StringContent(token_) : std::string_view();
+    }
+
+    Public inline long long GetInt64(long long defaultValue = 0) const;
+    Public inline double GetDouble(double defaultValue = 0.0) const;
+
+    Public Bool GetBool(Bool defaultValue = false) const {
+        if (GetType() != JsonType::Boolean) return defaultValue;
+        return ScalarText() == "true";
+    }
+
+    /**
+     * Raw JSON text of this value (including quotes/brackets), e.g. for forwarding a sub-document
+     */
+    Public inline std::string_view GetRawJson() const;
+};
+
+/**
+ * Reusable structural indexer for JSON documents
+ * Index() makes a single pass recording the offset of every structural character, string and
+ * scalar (skipping string contents with SimdScan) plus the matching close for every bracket.
+ * Buffers are kept between documents, so a thread-local parser stops allocating once it has
+ * seen its largest payload.
+ */
+class JsonParser {
+
+    friend class JsonValue;
+
+    Private std::string_view json_;
+    // Byte offset of each token: { } [ ] : , opening quote, or first byte of a scalar
+    Private StdVector<UInt> tokens_;
+    // For an opening bracket token, index of its closing token; unused for other tokens
+    Private StdVector<UInt> matching_;
+    Private StdVector<UInt> openStack_;
+    Private Bool valid_;
+
+    Private Static Bool IsScalarDelimiter(char c) {
+        switch (c) {
+            case ' ': case '\t': case '\n': case '\r':
+            case ',': case ':': case '{': case '}': case '[': case ']': case '"':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * What the grammar allows at the current position of BuildIndex()
+     */
+    Private enum class Expect {
+        Value,          // after ':' or ',' in an array, or the document start
+        ValueOrClose,   // just after '['
+        Key,            // after ',' in an object
+        KeyOrClose,     // just after '{'
+        Colon,          // after an object key
+        CommaOrClose,   // after a value inside a container
+        End             // after the root value: only whitespace may follow
+    };
+
+    /**
+     * Check a number against the JSON grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+     */
+    Private Static Bool IsValidNumber(std::string_view text) {
+        Size i = 0;
+        const Size length = text.size();
+        auto digits = [&text, &i, length]() {
+            const Size start = i;
+            while (i < length && text[i] >= '0' && text[i] <= '9') ++i;
+            return i > start;
+        };
+        if (i < length && text[i] == '-') ++i;
+        if (i < length && text[i] == '0') {
+            ++i;
+        } else if (!digits()) {
+            return false;
+        }
+        if (i < length && text[i] == '.') {
+            ++i;
+            if (!digits()) return false;
+        }
+        if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+            ++i;
+            if (i < length && (text[i] == '+' || text[i] == '-')) ++i;
+            if (!digits()) return false;
+        }
+        return i == length;
+    }
+
+    Private Static Bool IsValidScalar(std::string_view text) {
+        if (text == "true" || text == "false" || text == "null") return true;
+        return IsValidNumber(text);
+    }
+
+    Private Static Bool IsHexDigit(char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    /**
+     * Skip a string starting just after its opening quote
+     * @return Offset just past the closing quote, or length + 1 if the string is unterminated or malformed
+     */
+    Private Static Size SkipString(const char* data, Size length, Size i) {
+        for (;;) {
+            // Stops at '"', '\\' or a raw control character (not allowed inside strings)
+            i += SimdScan::FindJsonEscape(data + i, length - i);
+            if (i >= length) return length + 1;
+            if (data[i] == '"') return i + 1;
+            if (data[i] != '\\' || i + 1 >= length) return length + 1;
+            switch (data[i + 1]) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    i += 2;
+                    break;
+                case 'u':
+                    if (i + 6 > length || !IsHexDigit(data[i + 2]) || !IsHexDigit(data[i + 3]) ||
+                        !IsHexDigit(data[i + 4]) || !IsHexDigit(data[i + 5])) {
+                        return length + 1;
+                    }
+                    i += 6;
+                    break;
+                default:
+                    return length + 1;
+            }
+        }
+    }
+
+    /**
+     * Record every token and check the document against the JSON grammar
+     * @return false on any syntax error, including trailing bytes after the root value
+     */
+    Private Bool BuildIndex() {
+        const char* data = json_.data();
+        const Size length = json_.size();
+        if (length > 0xFFFFFFF0u) return false;
+
+        Expect expect = Expect::Value;
+        // State after a complete value, depending on whether it is nested
+        auto afterValue = [this]() { return openStack_.empty() ? Expect::End : Expect::CommaOrClose; };
+        Size i = 0;
+        while (i < length) {
+            const char c = data[i];
+            switch (c) {
+                case ' ': case '\t': case '\n': case '\r':
+                    ++i;
+                    break;
+                case '{': case '[':
+                    if (expect != Expect::Value && expect != Expect::ValueOrClose) return false;
+                    openStack_.push_back(static_cast<UInt>(tokens_.size()));
+                    tokens_.push_back(static_cast<UInt>(i));
+                    matching_.push_back(0);
+                    expect = c == '{' ? Expect::KeyOrClose : Expect::ValueOrClose;
+                    ++i;
+                    break;
+                case '}': case ']': {
+                    if (openStack_.empty()) return false;
+                    const UInt open = openStack_.back();
+                    const Bool object = data[tokens_[open]] == '{';
+                    if ((c == '}') != object) return false;
+                    // Empty container, or the end of a member/element list (no trailing comma)
+                    if (expect != Expect::CommaOrClose && expect != (object ? Expect::KeyOrClose : Expect::ValueOrClose)) {
+                        return false;
+                    }
+                    openStack_.pop_back();
+                    matching_[open] = static_cast<UInt>(tokens_.size());
+                    tokens_.push_back(static_cast<UInt>(i));
+                    matching_.push_back(0);
+                    expect = afterValue();
+                    ++i;
+                    break;
+                }
+                case ':':
+                    if (expect != Expect::Colon) return false;
+                    tokens_.push_back(static_cast<UInt>(i));
+                    matching_.push_back(0);
+                    expect = Expect::Value;
+                    ++i;
+                    break;
+                case ',':
+                    if (expect != Expect::CommaOrClose) return false;
+                    tokens_.push_back(static_cast<UInt>(i));
+                    matching_.push_back(0);
+                    expect = data[tokens_[openStack_.back()]] == '{' ? Expect::Key : Expect::Value;
+                    ++i;
+                    break;
+                case '"': {
+                    const Bool key = expect == Expect::Key || expect == Expect::KeyOrClose;
+                    if (!key && expect != Expect::Value && expect != Expect::ValueOrClose) return false;
+                    tokens_.push_back(static_cast<UInt>(i));
+                    matching_.push_back(0);
+                    i = SkipString(data, length, i + 1);
+                    if (i > length) return false;
+                    expect = key ? Expect::Colon : afterValue();
+                    break;
+                }
+                default: {
+                    if (expect != Expect::Value && expect != Expect::ValueOrClose) return false;
+                    const Size start = i;
+                    tokens_.push_back(static_cast<UInt>(i));
+                    matching_.push_back(0);
+                    while (i < length && !IsScalarDelimiter(data[i])) ++i;
+                    if (!IsValidScalar(std::string_view(data + start, i - start))) return false;
+                    expect = afterValue();
+                    break;
+                }
+            }
+        }
+        return expect == Expect::End;
+    }
+
+    Public JsonParser() : valid_(false) {}
+
+    /**
+     * Parser instance owned by the calling thread, reused across requests
+     */
+    Public Static JsonParser& ThreadLocal() {
+        static thread_local JsonParser parser;
+        return parser;
+    }
+
+    /**
+     * Index a JSON document and return a view of its root value
+     * The text is not copied: it must outlive every JsonValue obtained from this call,
+     * and those views are invalidated by the next Index() on this parser.
+     * @return Root value, or an Invalid view if the document is malformed
+     */
+    Public JsonValue Index(std::string_view json) {
+        json_ = json;
+        tokens_.clear();
+        matching_.clear();
+        openStack_.clear();
+        valid_ = BuildIndex();
+        return valid_ ? JsonValue(this, 0) : JsonValue();
+    }
+
+    Public Bool IsValid() const {
+        return valid_;
+    }
+
+    /**
+     * Release the buffers kept for reuse (e.g. after an unusually large document)
+     */
+    Public Void Shrink() {
+        StdVector<UInt>().swap(tokens_);
+        StdVector<UInt>().swap(matching_);
+        StdVector<UInt>().swap(openStack_);
+        json_ = std::string_view();
+        valid_ = false;
+    }
+};
+
+// ========== JsonValue inline implementation ==========
+
+inline char JsonValue::TokenChar(UInt token) const {
+    return parser_->json_[parser_->tokens_[token]];
+}
+
+inline UInt JsonValue::TokenCount() const {
+    return parser_ == nullptr ? 0 : static_cast<UInt>(parser_->tokens_.size());
+}
+
+inline UInt JsonValue::SkipValue(UInt token) const {
+    const char c = TokenChar(token);
+    if (c == '{' || c == '[') {
+        return parser_->matching_[token] + 1;
+    }
+    return token + 1;
+}
+
+inline std::string_view JsonValue::ScalarText() const {
+    const Size start = parser_->tokens_[token_];
+    Size end = start;
+    const std::string_view json = parser_->json_;
+    while (end < json.size() && !JsonParser::IsScalarDelimiter(json[end])) ++end;
+    return json.substr(start, end - start);
+}
+
+inline std::string_view JsonValue::StringContent(UInt token) const {
+    const std::string_view json = parser_->json_;
+    const Size start = parser_->tokens_[token] + 1;
+    Size end = start;
+    for (;;) {
+        end += SimdScan::FindQuoteOrBackslash(json.data() + end, json.size() - end);
+        if (end >= json.size() || json[end] == '"') break;
+        end += 2;
+    }
+    return json.substr(start, end - start);
+}
+
+inline JsonType JsonValue::GetType() const {
+    if (token_ >= TokenCount()) return JsonType::Invalid;
+    switch (TokenChar(token_)) {
+        case '{': return JsonType::Object;
+        case '[': return JsonType::Array;
+        case '"': return JsonType::String;
+        case 't': case 'f': return JsonType::Boolean;
+        case 'n': return JsonType::Null;
+        case '-': case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return JsonType::Number;
+        default: return JsonType::Invalid;
+    }
+}
+
+inline JsonValue JsonValue::operator[](std::string_view key) const {
+    if (GetType() != JsonType::Object) return JsonValue();
+    UInt token = token_ + 1;
+    while (token + 1 < TokenCount() && TokenChar(token) == '"' && TokenChar(token + 1) == ':') {
+        const std::string_view rawKey = StringContent(token);
+        if (rawKey == key) {
+            return JsonValue(parser_, token + 2);
+        }
+        // Escaped keys are rare; decode only when a raw comparison cannot decide
+        if (rawKey.find('\\') != std::string_view::npos && JsonValue(parser_, token).GetString() == key) {
+            return JsonValue(parser_, token + 2);
+        }
+        token = SkipValue(token + 2);
+        if (token >= TokenCount() || TokenChar(token) != ',') break;
+        ++token;
+    }
+    return JsonValue();
+}
+
+inline JsonValue JsonValue::operator[](Size index) const {
+    if (GetType() != JsonType::Array) return JsonValue();
+    UInt token = token_ + 1;
+    if (token < TokenCount() && TokenChar(token) == ']') return JsonValue();
+    Size position = 0;
+    while (token < TokenCount()) {
+        if (position++ == index) {
+            return JsonValue(parser_, token);
+        }
+        token = SkipValue(token);
+        if (token >= TokenCount() || TokenChar(token) != ',') break;
+        ++token;
+    }
+    return JsonValue();
+}
+
+inline Size JsonValue::GetSize() const {
+    Size count = 0;
+    if (GetType() == JsonType::Object) {
+        ForEachField([&](std::string_view, JsonValue) { ++count; });
+    } else if (GetType() == JsonType::Array) {
+        ForEachElement([&](JsonValue) { ++count; });
+    }
+    return count;
+}
+
+inline StdString JsonValue::GetString(CStdString& defaultValue) const {
+    if (GetType() != JsonType::String) return defaultValue;
+    const std::string_view raw = StringContent(token_);
+    if (raw.find('\\') == std::string_view::npos) {
+        return StdString(raw);
+    }
+
+    StdString result;
+    result.reserve(raw.size());
+    auto hexValue = [](std::string_view hex, unsigned long& out) -> Bool {
+        if (hex.size() < 4) return false;
+        const std::from_chars_result parsed = std::from_chars(hex.data(), hex.data() + 4, out, 16);
+        return parsed.ptr == hex.data() + 4;
+    };
+    auto appendUtf8 = [&result](unsigned long codePoint) {
+        if (codePoint < 0x80) {
+            result.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    };
+
+    Size i = 0;
+    while (i < raw.size()) {
+        const Size run = raw.find('\\', i);
+        if (run == std::string_view::npos) {
+            result.append(raw.data() + i, raw.size() - i);
+            break;
+        }
+        result.append(raw.data() + i, run - i);
+        i = run + 1;
+        if (i >= raw.size()) break;
+        const char escape = raw[i++];
+        switch (escape) {
+            case 'n': result.push_back('\n'); break;
+            case 'r': result.push_back('\r'); break;
+            case 't': result.push_back('\t'); break;
+            case 'b': result.push_back('\b'); break;
+            case 'f': result.push_back('\f'); break;
+            case 'u': {
+                unsigned long codePoint = 0;
+                if (!hexValue(raw.substr(i), codePoint)) return defaultValue;
+                i += 4;
+                // Combine UTF-16 surrogate pairs
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 6 <= raw.size() &&
+                    raw[i] == '\\' && raw[i + 1] == 'u') {
+                    unsigned long low = 0;
+                    if (hexValue(raw.substr(i + 2), low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                appendUtf8(codePoint);
+                break;
+            }
+            default: result.push_back(escape); break;
+        }
+    }
+    return result;
+}
+
+inline long long JsonValue::GetInt64(long long defaultValue) const {
+    if (GetType() != JsonType::Number) return defaultValue;
+    const std::string_view text = ScalarText();
+    long long value = 0;
+    const std::from_chars_result parsed = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (parsed.ec != std::errc()) return defaultValue;
+    if (parsed.ptr != text.data() + text.size()) {
+        // Fractional or exponent form: convert through double, only when the result fits (NaN and inf fail both tests)
+        const double converted = GetDouble(static_cast<double>(defaultValue));
+        const double limit = 9223372036854775808.0;   // 2^63
+        if (!(converted >= -limit && converted < limit)) return defaultValue;
+        return static_cast<long long>(converted);
+    }
+    return value;
+}
+
+inline double JsonValue::GetDouble(double defaultValue) const {
+    if (GetType() != JsonType::Number) return defaultValue;
+    const std::string_view text = ScalarText();
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    double value = 0.0;
+    const std::from_chars_result parsed = std::from_chars(text.data(), text.data() + text.size(), value);
+    return parsed.ec == std::errc() ? value : defaultValue;
+#else
+    // Floating point from_chars is missing from older toolchains; strtod needs a terminated copy
+    char buffer[64];
+    if (text.size() >= sizeof(buffer)) return defaultValue;
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    char* end = nullptr;
+    const double value = std::strtod(buffer, &end);
+    return end == buffer ? defaultValue : value;
+#endif
+}
+
+inline std::string_view JsonValue::GetRawJson() const {
+    switch (GetType()) {
+        case JsonType::Invalid:
+            return std::string_view();
+        case JsonType::Object:
+        case JsonType::Array: {
+            const UInt close = parser_->matching_[token_];
+            const Size start = parser_->tokens_[token_];
+            return parser_->json_.substr(start, parser_->tokens_[close] + 1 - start);
+        }
+        case JsonType::String: {
+            const std::string_view content = StringContent(token_);
+            return parser_->json_.substr(parser_->tokens_[token_], content.size() + 2);
+        }
+        default:
+            return ScalarText();
+    }
+}
+
+#endif // JSONVIEW_H
@@ -0,0 +1,261 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <StandardDefines.h>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <string_view>
+#include <utility>
+#include "SimdScan.h"
+
+/**
+ * Streaming JSON writer
+ * Serializes straight into a single growing buffer that is later moved into the response body,
+ * so JSON endpoints need no intermediate strings and the Content-Length is simply the buffer length.
+ *
+ * Commas and nesting are tracked by the writer; the caller only emits keys and values:
+ *   JsonWriter json;
+ *   json.BeginObject();
+ *   json.Key("id").Value(42);
+ *   json.Key("tags").BeginArray().Value("a").Value("b").EndArray();
+ *   json.EndObject();
+ *   IHttpResponsePtr response = HttpResponseBuilder(requestId).Json(std::move(json)).Build();
+ */
+class JsonWriter {
+
+    Private StdString buffer_;
+    // One entry per open object/array: true once the container holds at least one element
+    Private StdVector<Bool> hasElements_;
+    // Set after Key() so the following value is not preceded by a comma
+    Private Bool afterKey_;
+
+    Private Void BeforeValue() {
+        if (afterKey_) {
+            afterKey_ = false;
+            return;
+        }
+        if (!hasElements_.empty()) {
+            if (hasElements_.back()) {
+                buffer_.push_back(',');
+            }
+            hasElements_.back() = true;
+        }
+    }
+
+    Private Void AppendEscaped(std::string_view text) {
+        static const char hexDigits[] = "0123456789abcdef";
+        const char* data = text.data();
+        Size remaining = text.size();
+        while (remaining > 0) {
+            const Size run = SimdScan::FindJsonEscape(data, remaining);
+            buffer_.append(data, run);
+            if (run == remaining) {
+                break;
+            }
+            const char c = data[run];
+            switch (c) {
+                case '"': buffer_.append("\\\"", 2); break;
+                case '\\': buffer_.append("\\\\", 2); break;
+                case '\n': buffer_.append("\\n", 2); break;
+                case '\r': buffer_.append("\\r", 2); break;
+                case '\t': buffer_.append("\\t", 2); break;
+                case '\b': buffer_.append("\\b", 2); break;
+                case '\f': buffer_.append("\\f", 2); break;
+                default: {
+                    const unsigned char u = static_cast<unsigned char>(c);
+                    const char escaped[6] = { '\\', 'u', '0', '0', hexDigits[u >> 4], hexDigits[u & 0x0F] };
+                    buffer_.append(escaped, sizeof(escaped));
+                    break;
+                }
+            }
+            data += run + 1;
+            remaining -= run + 1;
+        }
+    }
+
+    Private template<typename Integer>
+    Void AppendInteger(Integer value) {
+        char digits[24];
+        const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, static_cast<Size>(result.ptr - digits));
+    }
+
+    /**
+     * @param reserveBytes Initial buffer capacity; size it to the typical response to avoid regrowth
+     */
+    Public explicit JsonWriter(Size reserveBytes = 256) : afterKey_(false) {
+        buffer_.reserve(reserveBytes);
+    }
+
+    // ========== Structure ==========
+
+    Public JsonWriter& BeginObject() {
+        BeforeValue();
+        buffer_.push_back('{');
+        hasElements_.push_back(false);
+        return *this;
+    }
+
+    Public JsonWriter& EndObject() {
+        buffer_.push_back('}');
+        if (!hasElements_.empty()) {
+            hasElements_.pop_back();
+        }
+        return *this;
+    }
+
+    Public JsonWriter& BeginArray() {
+        BeforeValue();
+        buffer_.push_back('[');
+        hasElements_.push_back(false);
+        return *this;
+    }
+
+    Public JsonWriter& EndArray() {
+        buffer_.push_back(']');
+        if (!hasElements_.empty()) {
+            hasElements_.pop_back();
+        }
+        return *this;
+    }
+
+    /**
+     * Write an object key; the next call must write its value
+     */
+    Public JsonWriter& Key(std::string_view name) {
+        BeforeValue();
+        buffer_.push_back('"');
+        AppendEscaped(name);
+        buffer_.append("\":", 2);
+        afterKey_ = true;
+        return *this;
+    }
+
+    // ========== Values ==========
+
+    Public JsonWriter& Value(std::string_view text) {
+        BeforeValue();
+        buffer_.push_back('"');
+        AppendEscaped(text);
+        buffer_.push_back('"');
+        return *this;
+    }
+
+    Public JsonWriter& Value(const char* text) {
+        if (text == nullptr) {
+            return Null();
+        }
+        return Value(std::string_view(text));
+    }
+
+    Public JsonWriter& Value(CStdString& text) {
+        return Value(std::string_view(text));
+    }
+
+    Public JsonWriter& Value(Bool flag) {
+        BeforeValue();
+        if (flag) {
+            buffer_.append("true", 4);
+        } else {
+            buffer_.append("false", 5);
+        }
+        return *this;
+    }
+
+    Public JsonWriter& Value(int number) { BeforeValue(); AppendInteger(number); return *this; }
+    Public JsonWriter& Value(unsigned int number) { BeforeValue(); AppendInteger(number); return *this; }
+    Public JsonWriter& Value(long number) { BeforeValue(); AppendInteger(number); return *this; }
+    Public JsonWriter& Value(unsigned long number) { BeforeValue(); AppendInteger(number); return *this; }
+    Public JsonWriter& Value(long long number) { BeforeValue(); AppendInteger(number); return *this; }
+    Public JsonWriter& Value(unsigned long long number) { BeforeValue(); AppendInteger(number); return *this; }
+
+    /**
+     * Write a floating point number in shortest round-trip form
+     * NaN and infinities have no JSON representation and are written as null.
+     */
+    Public JsonWriter& Value(double number) {
+        if (!std::isfinite(number)) {
+            return Null();
+        }
+        BeforeValue();
+        char digits[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number);
+        buffer_.append(digits, static_cast<Size>(result.ptr - digits));
+#else
+        // Floating point to_chars is missing from older toolchains (e.g. the ESP32 GCC)
+        const int written = std::snprintf(digits, sizeof(digits), "%.17g", number);
+        if (written > 0) {
+            buffer_.append(digits, static_cast<Size>(written));
+        }
+#endif
+        return *this;
+    }
+
+    Public JsonWriter& Null() {
+        BeforeValue();
+        buffer_.append("null", 4);
+        return *this;
+    }
+
+    /**
+     * Write an already serialized JSON fragment as the next value
+     */
+    Public JsonWriter& Raw(std::string_view json) {
+        BeforeValue();
+        buffer_.append(json.data(), json.size());
+        return *this;
+    }
+
+    /**
+     * Shorthand for Key(name).Value(value)
+     */
+    Public template<typename T>
+    JsonWriter& Field(std::string_view name, T&& value) {
+        Key(name);
+        return Value(std::forward<T>(value));
+    }
+
+    // ========== Output ==========
+
+    /**
+     * Number of bytes written so far (the Content-Length of the finished document)
+     */
+    Public Size GetLength() const {
+        return buffer_.size();
+    }
+
+    Public CStdString& GetBuffer() const {
+        return buffer_;
+    }
+
+    /**
+     * Check that every object and array has been closed
+     */
+    Public Bool IsComplete() const {
+        return hasElements_.empty() && !afterKey_ && !buffer_.empty();
+    }
+
+    /**
+     * Move the serialized document out of the writer, leaving it empty
+     */
+    Public StdString Release() {
+        StdString result = std::move(buffer_);
+        buffer_.clear();
+        hasElements_.clear();
+        afterKey_ = false;
+        return result;
+    }
+
+    /**
+     * Discard the written content but keep the buffer capacity for reuse
+     */
+    Public Void Clear() {
+        buffer_.clear();
+        hasElements_.clear();
+        afterKey_ = false;
+    }
+};
+
+#endif // JSONWRITER_H
@@ -0,0 +1,138 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Lock-free latency histogram with bounded relative error
+ * Values (microseconds) are counted in log-linear buckets: 16 linear sub-buckets per power of two,
+ * so a reported percentile is at most 1/16 (6.25%) above the true value. Recording is one relaxed
+ * atomic increment, safe from any number of threads. Values above about 2^40 us (12 days) are
+ * counted in the last bucket.
+ *
+ *   LatencyHistogram latency;
+ *   latency.Record(elapsedMicros);
+ *   ULong p99 = latency.GetPercentile(99.0);
+ */
+class LatencyHistogram {
+
+    Private Static constexpr UInt kSubBucketBits = 4;
+    Private Static constexpr UInt kSubBucketCount = 1u << kSubBucketBits;
+    Private Static constexpr UInt kMaxShift = 36;
+
+    Public Static constexpr UInt kBucketCount = (kMaxShift + 1) * kSubBucketCount + kSubBucketCount;
+
+    Private std::atomic<ULong> buckets_[kBucketCount];
+    Private std::atomic<ULong> count_;
+    Private std::atomic<ULong> sum_;
+    Private std::atomic<ULong> max_;
+
+    Private Static UInt HighestBit(std::uint64_t value) {
+        UInt bit = 0;
+        while (value >>= 1) ++bit;
+        return bit;
+    }
+
+    /**
+     * Values below 32 map to themselves; above, (shift, top 5 bits) select the bucket
+     */
+    Private Static UInt BucketIndex(std::uint64_t value) {
+        if (value < 2 * kSubBucketCount) return static_cast<UInt>(value);
+        UInt shift = HighestBit(value) - kSubBucketBits;
+        if (shift > kMaxShift) return kBucketCount - 1;
+        return shift * kSubBucketCount + static_cast<UInt>(value >> shift);
+    }
+
+    /**
+     * Largest value counted in a bucket
+     */
+    Private Static ULong BucketUpperBound(UInt index) {
+        if (index < 2 * kSubBucketCount) return index;
+        const UInt shift = index / kSubBucketCount - 1;
+        const std::uint64_t sub = index % kSubBucketCount + kSubBucketCount;
+        return static_cast<ULong>(((sub + 1) << shift) - 1);
+    }
+
+    Public LatencyHistogram() {
+        Reset();
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    Public Void Record(ULong micros) {
+        buckets_[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        ULong previous = max_.load(std::memory_order_relaxed);
+        while (micros > previous && !max_.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Add all values recorded in another histogram (e.g. per-thread histograms into a total)
+     */
+    Public Void Merge(const LatencyHistogram& other) {
+        for (UInt index = 0; index < kBucketCount; ++index) {
+            const ULong value = other.buckets_[index].load(std::memory_order_relaxed);
+            if (value != 0) buckets_[index].fetch_add(value, std::memory_order_relaxed);
+        }
+        count_.fetch_add(other.GetCount(), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        const ULong otherMax = other.GetMax();
+        ULong previous = max_.load(std::memory_order_relaxed);
+        while (otherMax > previous && !max_.compare_exchange_weak(previous, otherMax, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Smallest bucket bound at or above the given percentage of recorded values
+     * @param percentile 0-100, e.g. 99.9
+     * @return Microseconds, 0 if nothing has been recorded
+     */
+    Public ULong GetPercentile(double percentile) const {
+        const ULong total = GetCount();
+        if (total == 0) return 0;
+        if (percentile < 0.0) percentile = 0.0;
+        if (percentile > 100.0) percentile = 100.0;
+        ULong target = static_cast<ULong>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+        if (target == 0) target = 1;
+        ULong seen = 0;
+        for (UInt index = 0; index < kBucketCount; ++index) {
+            seen += buckets_[index].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                const ULong bound = BucketUpperBound(index);
+                const ULong maximum = GetMax();
+                return bound < maximum ? bound : maximum;
+            }
+        }
+        return GetMax();
+    }
+
+    Public ULong GetCount() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    Public ULong GetMax() const {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    Public double GetMean() const {
+        const ULong total = GetCount();
+        return total == 0 ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(total);
+    }
+
+    /**
+     * Clear all counts; not atomic with respect to concurrent Record() calls
+     */
+    Public Void Reset() {
+        for (UInt index = 0; index < kBucketCount; ++index) buckets_[index].store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,284 @@
+#ifndef LISTENERHANDOFF_H
+#define LISTENERHANDOFF_H
+
+#include <StandardDefines.h>
+#include "IServer.h"
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Zero-downtime restart by passing listening sockets to a successor process
+ * The running process exports its listeners over a Unix domain socket with SCM_RIGHTS; the new
+ * binary adopts them before Start(), so the kernel listen queue (and every connection waiting in
+ * it) survives the restart and no connection is refused:
+ *
+ *   // old process, on a restart signal
+ *   ListenerHandoff::Export(*server, "/run/myapp/handoff.sock", 30000);
+ *   server->StopAsync(10000).wait();
+ *
+ *   // new process
+ *   ListenerHandoff::Adopt(*server, "/run/myapp/handoff.sock", 5000);
+ *   server->Start(port);
+ *
+ * Servers take part by implementing IServer::GetListeningSockets() and AdoptListeningSockets().
+ * The handoff socket is created mode 0600 and both sides only talk to a peer running as the same
+ * effective user, so other local users cannot take the listeners or inject their own.
+ */
+namespace ListenerHandoff {
+
+    // Upper bound on listeners passed in one message
+    static constexpr Size kMaxSockets = 16;
+    static constexpr char kMagic[8] = { 's', 'l', 'h', 'o', 'f', 'f', '1', '\0' };
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+    inline Bool MakeAddress(CStdString& path, sockaddr_un& address) {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.length() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.length() + 1);
+        return true;
+    }
+
+    inline Bool WaitReadable(int fd, CUInt timeoutMs) {
+        pollfd entry{};
+        entry.fd = fd;
+        entry.events = POLLIN;
+        int result;
+        do {
+            result = ::poll(&entry, 1, static_cast<int>(timeoutMs));
+        } while (result < 0 && errno == EINTR);
+        return result > 0;
+    }
+
+    /**
+     * Credentials of the process at the other end of a connected Unix domain socket
+     * @param pid Set to the peer's pid, or -1 where the platform does not report it
+     */
+    inline Bool GetPeerCredentials(int channel, uid_t& uid, pid_t& pid) {
+#if defined(SO_PEERCRED) && defined(SERVERLIB_LINUX)
+        ucred credentials{};
+        socklen_t length = sizeof(credentials);
+        if (::getsockopt(channel, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0 || length != sizeof(credentials)) {
+            return false;
+        }
+        uid = credentials.uid;
+        pid = credentials.pid;
+        return true;
+#else
+        gid_t gid;
+        pid = -1;
+        return ::getpeereid(channel, &uid, &gid) == 0;
+#endif
+    }
+
+    /**
+     * True if the peer runs as our effective user and, when expectedPid is set, is that process
+     */
+    inline Bool IsTrustedPeer(int channel, pid_t expectedPid) {
+        uid_t uid;
+        pid_t pid;
+        if (!GetPeerCredentials(channel, uid, pid) || uid != ::geteuid()) {
+            return false;
+        }
+        return expectedPid <= 0 || pid == expectedPid;
+    }
+
+    /**
+     * Send file descriptors over a connected Unix domain socket
+     */
+    inline Bool SendSockets(int channel, const StdVector<int>& sockets) {
+        if (sockets.empty() || sockets.size() > kMaxSockets) {
+            return false;
+        }
+        char payload[sizeof(kMagic) + 1];
+        std::memcpy(payload, kMagic, sizeof(kMagic));
+        payload[sizeof(kMagic)] = static_cast<char>(sockets.size());
+        iovec data{ payload, sizeof(payload) };
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxSockets)];
+        std::memset(control, 0, sizeof(control));
+        msghdr message{};
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = CMSG_SPACE(sizeof(int) * sockets.size());
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int) * sockets.size());
+        std::memcpy(CMSG_DATA(header), sockets.data(), sizeof(int) * sockets.size());
+
+        ssize_t sent;
+        do {
+            sent = ::sendmsg(channel, &message, 0);
+        } while (sent < 0 && errno == EINTR);
+        return sent == static_cast<ssize_t>(sizeof(payload));
+    }
+
+    /**
+     * Receive file descriptors sent with SendSockets()
+     * @return Received descriptors (owned by the caller), empty on error
+     */
+    inline StdVector<int> ReceiveSockets(int channel) {
+        StdVector<int> sockets;
+        char payload[sizeof(kMagic) + 1];
+        iovec data{ payload, sizeof(payload) };
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxSockets)];
+        msghdr message{};
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+        flags |= MSG_CMSG_CLOEXEC;
+#endif
+        ssize_t received;
+        do {
+            received = ::recvmsg(channel, &message, flags);
+        } while (received < 0 && errno == EINTR);
+
+        for (cmsghdr* header = CMSG_FIRSTHDR(&message); received > 0 && header != nullptr;
+             header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+                const Size count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                sockets.resize(count);
+                std::memcpy(sockets.data(), CMSG_DATA(header), sizeof(int) * count);
+            }
+        }
+
+        const Bool valid = received == static_cast<ssize_t>(sizeof(payload)) &&
+            std::memcmp(payload, kMagic, sizeof(kMagic)) == 0 &&
+            static_cast<Size>(static_cast<unsigned char>(payload[sizeof(kMagic)])) == sockets.size() &&
+            (message.msg_flags & MSG_CTRUNC) == 0;
+        if (!valid) {
+            for (int fd : sockets) {
+                ::close(fd);
+            }
+            sockets.clear();
+        }
+        return sockets;
+    }
+#endif
+
+    /**
+     * Hand the server's listening sockets to a successor process
+     * Listens on unixSocketPath (mode 0600), waits for the successor to connect and sends it the
+     * listeners. Connections from another user, or from a process other than expectedPid, are
+     * closed and the wait continues. The server keeps its own copies; drain it with StopAsync() afterwards.
+     * @param server Running server whose listeners are exported
+     * @param unixSocketPath Filesystem path of the handoff socket (replaced if it exists)
+     * @param timeoutMs How long to wait for the successor in milliseconds
+     * @param expectedPid Pid of the successor if known (e.g. the exporter forked it), 0 for any
+     *                    process of the same user; ignored where the platform cannot report peer pids
+     * @return true if the listeners were delivered
+     */
+    inline Bool Export(const IServer& server, CStdString& unixSocketPath, CUInt timeoutMs, int expectedPid = 0) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        const StdVector<int> sockets = server.GetListeningSockets();
+        sockaddr_un address;
+        if (sockets.empty() || !MakeAddress(unixSocketPath, address)) {
+            return false;
+        }
+        const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0) {
+            return false;
+        }
+        ::unlink(unixSocketPath.c_str());
+        // The socket file is created with the umask applied; keep it owner-only from the start
+        // (umask is process-wide, but restored right after bind)
+        const mode_t previousMask = ::umask(0177);
+        const Bool bound = ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        ::umask(previousMask);
+        Bool delivered = false;
+        if (bound && ::chmod(unixSocketPath.c_str(), S_IRUSR | S_IWUSR) == 0 && ::listen(listener, 1) == 0) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            while (!delivered) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (remaining <= 0 || !WaitReadable(listener, static_cast<UInt>(remaining))) {
+                    break;
+                }
+                const int channel = ::accept(listener, nullptr, nullptr);
+                if (channel < 0) {
+                    continue;
+                }
+                if (IsTrustedPeer(channel, static_cast<pid_t>(expectedPid))) {
+                    delivered = SendSockets(channel, sockets);
+                    ::close(channel);
+                    break;
+                }
+                ::close(channel);
+            }
+        }
+        ::close(listener);
+        ::unlink(unixSocketPath.c_str());
+        return delivered;
+#else
+        (void)server;
+        (void)unixSocketPath;
+        (void)timeoutMs;
+        (void)expectedPid;
+        return false;
+#endif
+    }
+
+    /**
+     * Take over the listening sockets of a predecessor process
+     * Call before Start(); the server then listens on the adopted sockets instead of binding.
+     * @param server Stopped server that adopts the listeners
+     * @param unixSocketPath Path the predecessor is exporting on
+     * @param timeoutMs How long to wait for the predecessor in milliseconds
+     * @return true if the listeners were received and adopted; false means bind normally
+     */
+    inline Bool Adopt(IServer& server, CStdString& unixSocketPath, CUInt timeoutMs) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        sockaddr_un address;
+        if (!MakeAddress(unixSocketPath, address)) {
+            return false;
+        }
+        const int channel = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (channel < 0) {
+            return false;
+        }
+        StdVector<int> sockets;
+        // Only accept listeners from a process of our own user
+        if (::connect(channel, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+            IsTrustedPeer(channel, 0) && WaitReadable(channel, timeoutMs)) {
+            sockets = ReceiveSockets(channel);
+        }
+        ::close(channel);
+        if (sockets.empty()) {
+            return false;
+        }
+        if (!server.AdoptListeningSockets(sockets)) {
+            for (int fd : sockets) {
+                ::close(fd);
+            }
+            return false;
+        }
+        return true;
+#else
+        (void)server;
+        (void)unixSocketPath;
+        (void)timeoutMs;
+        return false;
+#endif
+    }
+}
+
+#endif // LISTENERHANDOFF_H
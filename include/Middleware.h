@@ -0,0 +1,202 @@
+#ifndef MIDDLEWARE_H
+#define MIDDLEWARE_H
+
+#include <StandardDefines.h>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "IHttpRequest.h"
+#include "IHttpResponse.h"
+#include "IServer.h"
+
+/**
+ * Middleware pipelines: cross-cutting stages (auth, CORS, logging, metrics) wrapped around a handler
+ *
+ * A stage is any class with
+ *
+ *   template<typename Next>
+ *   IHttpResponsePtr Handle(const IHttpRequestPtr& request, Next&& next);
+ *
+ * that either returns its own response (short-circuit, e.g. 401) or calls next(request) and may
+ * inspect the result. Stages compose two ways:
+ *  - MiddlewarePipeline<Stages...>: fixed at compile time; every next() is a lambda the compiler
+ *    inlines, so the whole chain becomes one function with no std::function hops.
+ *  - MiddlewareChain: IMiddleware stages added at runtime (plugins); one virtual call per stage.
+ *    Compile-time stages plug in through MiddlewareAdapter<Stage>.
+ */
+
+/**
+ * Compile-time composed chain of stages
+ *
+ *   MiddlewarePipeline<RequestLogger, BearerAuth, Metrics> pipeline;
+ *   IHttpResponsePtr response = pipeline.Handle(request, [](const IHttpRequestPtr& r) { return Route(r); });
+ */
+template<typename... Stages>
+class MiddlewarePipeline {
+
+    Private std::tuple<Stages...> stages_;
+
+    template<Size Index, typename Handler>
+    IHttpResponsePtr Invoke(const IHttpRequestPtr& request, Handler& handler) {
+        if constexpr (Index == sizeof...(Stages)) {
+            return handler(request);
+        } else {
+            return std::get<Index>(stages_).Handle(request, [this, &handler](const IHttpRequestPtr& forwarded) {
+                return this->template Invoke<Index + 1>(forwarded, handler);
+            });
+        }
+    }
+
+    Public MiddlewarePipeline() = default;
+
+    /**
+     * Construct from stage instances; a stage type may be a reference (e.g. RequestCoalescer&) to share one stage
+     */
+    Public explicit MiddlewarePipeline(Stages... stages) : stages_(std::forward<Stages>(stages)...) {}
+
+    /**
+     * Run the request through every stage and then the handler
+     * @param handler Callable IHttpResponsePtr(const IHttpRequestPtr&) producing the response
+     */
+    template<typename Handler>
+    IHttpResponsePtr Handle(const IHttpRequestPtr& request, Handler&& handler) {
+        return Invoke<0>(request, handler);
+    }
+
+    /**
+     * Access a stage, e.g. to read its counters
+     */
+    template<Size Index>
+    auto& GetStage() {
+        return std::get<Index>(stages_);
+    }
+};
+
+class MiddlewareChain;
+
+/**
+ * Continuation handed to runtime stages; calling it runs the rest of the chain
+ */
+class MiddlewareNext {
+
+    Private MiddlewareChain& chain_;
+    Private Size index_;
+
+    Public MiddlewareNext(MiddlewareChain& chain, Size index) : chain_(chain), index_(index) {}
+
+    /**
+     * Continue with the next stage (or the handler after the last one)
+     */
+    Public inline IHttpResponsePtr operator()(const IHttpRequestPtr& request) const;
+};
+
+/**
+ * Runtime stage interface, for stages chosen by configuration or loaded as plugins
+ */
+DefineStandardPointers(IMiddleware)
+class IMiddleware {
+    Public Virtual ~IMiddleware() = default;
+
+    Public Virtual IHttpResponsePtr Handle(const IHttpRequestPtr& request, const MiddlewareNext& next) = 0;
+};
+
+/**
+ * Wraps a compile-time stage so it can be added to a MiddlewareChain
+ */
+template<typename Stage>
+class MiddlewareAdapter : public IMiddleware {
+
+    Private Stage stage_;
+
+    Public MiddlewareAdapter() = default;
+
+    Public explicit MiddlewareAdapter(Stage stage) : stage_(std::move(stage)) {}
+
+    Public Virtual IHttpResponsePtr Handle(const IHttpRequestPtr& request, const MiddlewareNext& next) override {
+        return stage_.Handle(request, next);
+    }
+
+    Public Stage& GetStage() {
+        return stage_;
+    }
+};
+
+/**
+ * Runtime composed chain of IMiddleware stages
+ *
+ *   MiddlewareChain chain([](const IHttpRequestPtr& r) { return Route(r); });
+ *   chain.Use(make_ptr<MiddlewareAdapter<BearerAuth>>());
+ *   chain.Use(LoadPluginStage("audit"));
+ *   IHttpResponsePtr response = chain.Handle(request);
+ */
+class MiddlewareChain {
+
+    Private StdVector<IMiddlewarePtr> stages_;
+    Private std::function<IHttpResponsePtr(const IHttpRequestPtr&)> handler_;
+
+    Public MiddlewareChain() = default;
+
+    Public explicit MiddlewareChain(std::function<IHttpResponsePtr(const IHttpRequestPtr&)> handler)
+        : handler_(std::move(handler)) {}
+
+    /**
+     * Append a stage; stages run in the order they were added
+     */
+    Public MiddlewareChain& Use(IMiddlewarePtr stage) {
+        if (stage != nullptr) stages_.push_back(std::move(stage));
+        return *this;
+    }
+
+    Public MiddlewareChain& SetHandler(std::function<IHttpResponsePtr(const IHttpRequestPtr&)> handler) {
+        handler_ = std::move(handler);
+        return *this;
+    }
+
+    Public Size GetStageCount() const {
+        return stages_.size();
+    }
+
+    Public IHttpResponsePtr Handle(const IHttpRequestPtr& request) {
+        return Invoke(0, request);
+    }
+
+    Public IHttpResponsePtr Invoke(Size index, const IHttpRequestPtr& request) {
+        if (index < stages_.size()) {
+            return stages_[index]->Handle(request, MiddlewareNext(*this, index + 1));
+        }
+        return handler_ ? handler_(request) : nullptr;
+    }
+};
+
+inline IHttpResponsePtr MiddlewareNext::operator()(const IHttpRequestPtr& request) const {
+    return chain_.Invoke(index_, request);
+}
+
+namespace Middleware {
+
+    /**
+     * Receive one request, run it through a pipeline or chain, and send the response
+     * Suitable as the worker step of a request loop (e.g. PreforkSupervisor). No pending request,
+     * a handler without a response and a client that went away only end this step, not the loop.
+     * @param pipeline MiddlewarePipeline or MiddlewareChain
+     * @param handler Final handler, passed to MiddlewarePipeline::Handle (ignored for a MiddlewareChain)
+     * @return true while the server is running (keep calling), false once it has stopped
+     */
+    template<typename Pipeline, typename Handler>
+    Bool ServeOne(IServer& server, Pipeline& pipeline, Handler&& handler) {
+        IHttpRequestPtr request = server.ReceiveMessage();
+        if (request == nullptr) return server.IsRunning();
+        IHttpResponsePtr response;
+        if constexpr (std::is_same<Pipeline, MiddlewareChain>::value) {
+            (void)handler;
+            response = pipeline.Handle(request);
+        } else {
+            response = pipeline.Handle(request, handler);
+        }
+        if (response != nullptr) server.SendMessage(request->GetRequestId(), response->ToHttpString());
+        return server.IsRunning();
+    }
+}
+
+#endif // MIDDLEWARE_H
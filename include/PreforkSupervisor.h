@@ -0,0 +1,275 @@
+#ifndef PREFORKSUPERVISOR_H
+#define PREFORKSUPERVISOR_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+#include "IServer.h"
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <arpa/inet.h>
+#include <csignal>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#ifdef SERVERLIB_LINUX
+#include <sys/prctl.h>
+#endif
+
+/**
+ * Multi-process (prefork) mode for handlers that are not thread-safe
+ * The supervisor binds the listener once, then forks N workers. Each worker creates its own server
+ * through the factory, adopts the shared listener (IServer::AdoptListeningSockets) and runs its own
+ * request loop, so handlers never run concurrently inside one process. Crashed workers are
+ * restarted, and every worker publishes its message counters to a shared-memory page from which
+ * the supervisor reports totals:
+ *
+ *   PreforkSupervisor supervisor(
+ *       []() { return ServerProvider::GetDefaultServer(); },
+ *       [](IServer& server) {
+ *           IHttpRequestPtr request = server.ReceiveMessage();
+ *           if (request) server.SendMessage(request->GetRequestId(), Handle(request));
+ *           return true;
+ *       },
+ *       4);
+ *   supervisor.Run(8080);   // blocks until RequestStop()
+ */
+class PreforkSupervisor {
+
+    Public Static constexpr UInt kMaxWorkers = 64;
+
+    /**
+     * Per-worker counters in the shared page; each slot is written by one worker only
+     */
+    Private class WorkerSlot {
+        Public std::atomic<std::uint64_t> received;
+        Public std::atomic<std::uint64_t> sent;
+        Public std::atomic<std::uint64_t> heartbeat;
+        // Keep slots on separate cache lines so workers do not contend
+        Public char padding[64 - 3 * sizeof(std::atomic<std::uint64_t>)];
+    };
+
+    Private std::function<IServerPtr()> serverFactory_;
+    Private std::function<Bool(IServer&)> workerStep_;
+    Private UInt workerCount_;
+    Private std::atomic<Bool> stopRequested_;
+    Private WorkerSlot* slots_;
+    Private StdVector<int> workerPids_;
+    // Pid of the process running Run(); workers exit once their parent is no longer this process
+    Private int supervisorPid_;
+    // Counters of workers that exited, so totals survive restarts
+    Private std::atomic<std::uint64_t> retiredReceived_;
+    Private std::atomic<std::uint64_t> retiredSent_;
+    Private std::atomic<ULong> restartCount_;
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+    Private Static int BindListener(CStdString& ip, CUInt port) {
+        const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listener < 0) return -1;
+        const int enable = 1;
+        ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(port));
+        if (::inet_pton(AF_INET, ip.c_str(), &address.sin_addr) != 1 ||
+            ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listener, SOMAXCONN) != 0) {
+            ::close(listener);
+            return -1;
+        }
+        return listener;
+    }
+
+    /**
+     * Body of a worker process; never returns
+     */
+    Private [[noreturn]] Void RunWorker(UInt slot, int listener, CUInt port) {
+        ::signal(SIGTERM, SIG_DFL);
+        ::signal(SIGINT, SIG_DFL);
+#ifdef SERVERLIB_LINUX
+        // Terminate with the supervisor even while blocked in the worker step
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+        // The supervisor may have died before prctl() took effect
+        if (::getppid() != static_cast<pid_t>(supervisorPid_)) ::_exit(0);
+        IServerPtr server = serverFactory_ ? serverFactory_() : nullptr;
+        if (server == nullptr || !server->AdoptListeningSockets(StdVector<int>{ listener }) || !server->Start(port)) {
+            ::_exit(2);
+        }
+        WorkerSlot& counters = slots_[slot];
+        // Compare with the saved pid rather than 1: the supervisor may itself be PID 1 (containers),
+        // and orphans may be reparented to a subreaper instead of init
+        while (::getppid() == static_cast<pid_t>(supervisorPid_)) {
+            const Bool keepRunning = workerStep_(*server);
+            counters.received.store(server->GetReceivedMessageCount(), std::memory_order_relaxed);
+            counters.sent.store(server->GetSentMessageCount(), std::memory_order_relaxed);
+            counters.heartbeat.fetch_add(1, std::memory_order_relaxed);
+            if (!keepRunning) break;
+        }
+        server->Stop();
+        ::_exit(0);
+    }
+
+    Private Bool SpawnWorker(UInt slot, int listener, CUInt port) {
+        slots_[slot].received.store(0, std::memory_order_relaxed);
+        slots_[slot].sent.store(0, std::memory_order_relaxed);
+        slots_[slot].heartbeat.store(0, std::memory_order_relaxed);
+        const pid_t pid = ::fork();
+        if (pid < 0) return false;
+        if (pid == 0) RunWorker(slot, listener, port);
+        workerPids_[slot] = static_cast<int>(pid);
+        return true;
+    }
+
+    Private Void RetireSlot(UInt slot) {
+        retiredReceived_.fetch_add(slots_[slot].received.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        retiredSent_.fetch_add(slots_[slot].sent.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        slots_[slot].received.store(0, std::memory_order_relaxed);
+        slots_[slot].sent.store(0, std::memory_order_relaxed);
+        workerPids_[slot] = 0;
+    }
+#endif
+
+    /**
+     * @param serverFactory Creates the server inside each worker process
+     * @param workerStep Called in a loop inside each worker (typically handles one request); return false to exit the worker
+     * @param workerCount Number of worker processes (capped at kMaxWorkers)
+     */
+    Public PreforkSupervisor(std::function<IServerPtr()> serverFactory,
+                             std::function<Bool(IServer&)> workerStep,
+                             CUInt workerCount)
+        : serverFactory_(std::move(serverFactory)), workerStep_(std::move(workerStep)),
+          workerCount_(workerCount == 0 ? 1 : (workerCount > kMaxWorkers ? kMaxWorkers : workerCount)),
+          stopRequested_(false), slots_(nullptr), workerPids_(workerCount_, 0), supervisorPid_(0),
+          retiredReceived_(0), retiredSent_(0), restartCount_(0) {
+    }
+
+    Public ~PreforkSupervisor() {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (slots_ != nullptr) {
+            ::munmap(slots_, sizeof(WorkerSlot) * kMaxWorkers);
+        }
+#endif
+    }
+
+    PreforkSupervisor(const PreforkSupervisor&) = delete;
+    PreforkSupervisor& operator=(const PreforkSupervisor&) = delete;
+
+    /**
+     * Bind the listener, start the workers and supervise them until RequestStop() is called
+     * @param port Port to listen on
+     * @param ip Address to bind (IPv4)
+     * @return true after a clean stop, false if the listener or shared page could not be set up
+     */
+    Public Bool Run(CUInt port = DEFAULT_SERVER_PORT, CStdString& ip = "0.0.0.0") {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (slots_ == nullptr) {
+            void* page = ::mmap(nullptr, sizeof(WorkerSlot) * kMaxWorkers, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (page == MAP_FAILED) return false;
+            slots_ = static_cast<WorkerSlot*>(page);
+            for (UInt slot = 0; slot < kMaxWorkers; ++slot) {
+                new (&slots_[slot]) WorkerSlot();
+            }
+        }
+        const int listener = BindListener(ip, port);
+        if (listener < 0) return false;
+
+        stopRequested_.store(false, std::memory_order_release);
+        supervisorPid_ = static_cast<int>(::getpid());
+        for (UInt slot = 0; slot < workerCount_; ++slot) {
+            SpawnWorker(slot, listener, port);
+        }
+
+        auto lastSpawn = std::chrono::steady_clock::now();
+        while (!stopRequested_.load(std::memory_order_acquire)) {
+            Bool anyExited = false;
+            // Wait only on our own workers: other children of this process belong to someone else
+            for (UInt slot = 0; slot < workerCount_; ++slot) {
+                if (workerPids_[slot] <= 0) continue;
+                int status = 0;
+                if (::waitpid(static_cast<pid_t>(workerPids_[slot]), &status, WNOHANG) <= 0) continue;
+                anyExited = true;
+                RetireSlot(slot);
+                // Back off when workers die right after starting, to avoid a fork loop
+                if (std::chrono::steady_clock::now() - lastSpawn < std::chrono::seconds(1)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                }
+                if (!stopRequested_.load(std::memory_order_acquire) && SpawnWorker(slot, listener, port)) {
+                    restartCount_.fetch_add(1, std::memory_order_relaxed);
+                    lastSpawn = std::chrono::steady_clock::now();
+                }
+            }
+            if (!anyExited) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+
+        for (UInt slot = 0; slot < workerCount_; ++slot) {
+            if (workerPids_[slot] > 0) ::kill(static_cast<pid_t>(workerPids_[slot]), SIGTERM);
+        }
+        for (UInt slot = 0; slot < workerCount_; ++slot) {
+            if (workerPids_[slot] > 0) {
+                ::waitpid(static_cast<pid_t>(workerPids_[slot]), nullptr, 0);
+                RetireSlot(slot);
+            }
+        }
+        ::close(listener);
+        return true;
+#else
+        (void)port;
+        (void)ip;
+        return false;
+#endif
+    }
+
+    /**
+     * Ask Run() to stop the workers and return; safe to call from a signal handler or another thread
+     */
+    Public Void RequestStop() {
+        stopRequested_.store(true, std::memory_order_release);
+    }
+
+    Public UInt GetWorkerCount() const {
+        return workerCount_;
+    }
+
+    /**
+     * Number of workers restarted after exiting or crashing
+     */
+    Public ULong GetRestartCount() const {
+        return restartCount_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Messages received by all workers, including workers that have since been restarted
+     */
+    Public ULong GetReceivedMessageCount() const {
+        std::uint64_t total = retiredReceived_.load(std::memory_order_relaxed);
+        for (UInt slot = 0; slots_ != nullptr && slot < workerCount_; ++slot) {
+            total += slots_[slot].received.load(std::memory_order_relaxed);
+        }
+        return static_cast<ULong>(total);
+    }
+
+    /**
+     * Messages sent by all workers, including workers that have since been restarted
+     */
+    Public ULong GetSentMessageCount() const {
+        std::uint64_t total = retiredSent_.load(std::memory_order_relaxed);
+        for (UInt slot = 0; slots_ != nullptr && slot < workerCount_; ++slot) {
+            total += slots_[slot].sent.load(std::memory_order_relaxed);
+        }
+        return static_cast<ULong>(total);
+    }
+};
+
+#endif // PREFORKSUPERVISOR_H
@@ -0,0 +1,174 @@
+#ifndef PROXYPROTOCOL_H
+#define PROXYPROTOCOL_H
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "ClientAddress.h"
+
+/**
+ * Result of parsing the start of a connection for a PROXY protocol preamble
+ */
+enum class ProxyParseStatus {
+    NeedMore,   // Not enough bytes yet to decide
+    Complete,   // Preamble parsed; skip GetLength() bytes before the HTTP request
+    NotProxy,   // Connection does not start with a preamble
+    Invalid     // Malformed preamble; close the connection
+};
+
+/**
+ * Addresses carried by a PROXY protocol v1/v2 preamble
+ */
+class ProxyHeader {
+
+    /**
+     * The real client, as seen by the load balancer
+     */
+    Public ClientAddress source;
+    Public ClientAddress destination;
+
+    /**
+     * Bytes occupied by the preamble at the start of the connection
+     */
+    Public Size length = 0;
+
+    /**
+     * LOCAL (v2) or UNKNOWN (v1): health check by the proxy itself, keep the socket peer address
+     */
+    Public Bool isLocal = false;
+};
+
+/**
+ * HAProxy PROXY protocol (v1 text and v2 binary) parsing for connections behind an L4 load balancer
+ * Run on the first bytes read from an accepted connection, before HTTP parsing; then report the
+ * source address to the request (SimpleHttpRequest::SetClientAddress) instead of the socket peer:
+ *
+ *   ProxyHeader header;
+ *   switch (ProxyProtocol::Parse(buffer.data(), buffer.size(), header)) {
+ *       case ProxyParseStatus::NeedMore: return;                 // read more
+ *       case ProxyParseStatus::Invalid: CloseConnection(); return;
+ *       case ProxyParseStatus::Complete:
+ *           if (!header.isLocal) peer = header.source;
+ *           buffer.erase(0, header.length);
+ *           break;
+ *       case ProxyParseStatus::NotProxy: break;
+ *   }
+ */
+namespace ProxyProtocol {
+
+    static constexpr Size kV1MaxLength = 107;
+    static constexpr char kV2Signature[12] = { '\r', '\n', '\r', '\n', '\0', '\r', '\n', 'Q', 'U', 'I', 'T', '\n' };
+
+    inline Bool ParsePort(std::string_view text, std::uint16_t& port) {
+        if (text.empty() || text.size() > 5) return false;
+        UInt value = 0;
+        for (char c : text) {
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + static_cast<UInt>(c - '0');
+        }
+        if (value > 65535) return false;
+        port = static_cast<std::uint16_t>(value);
+        return true;
+    }
+
+    /**
+     * "PROXY TCP4 <src> <dst> <sport> <dport>\r\n" or "PROXY UNKNOWN ...\r\n"
+     */
+    inline ProxyParseStatus ParseV1(const char* data, Size length, ProxyHeader& out) {
+        const Size limit = length < kV1MaxLength ? length : kV1MaxLength;
+        const char* end = static_cast<const char*>(std::memchr(data, '\n', limit));
+        if (end == nullptr) {
+            return length >= kV1MaxLength ? ProxyParseStatus::Invalid : ProxyParseStatus::NeedMore;
+        }
+        if (end == data || end[-1] != '\r') return ProxyParseStatus::Invalid;
+        const std::string_view line(data + 6, static_cast<Size>(end - 1 - (data + 6)));
+
+        std::string_view fields[5];
+        Size count = 0;
+        Size position = 0;
+        while (position <= line.size() && count < 5) {
+            Size space = line.find(' ', position);
+            if (space == std::string_view::npos) space = line.size();
+            fields[count++] = line.substr(position, space - position);
+            position = space + 1;
+        }
+        out = ProxyHeader();
+        out.length = static_cast<Size>(end + 1 - data);
+        if (count >= 1 && fields[0] == "UNKNOWN") {
+            out.isLocal = true;
+            return ProxyParseStatus::Complete;
+        }
+        if (count != 5 || position <= line.size() || (fields[0] != "TCP4" && fields[0] != "TCP6")) {
+            return ProxyParseStatus::Invalid;
+        }
+        std::uint16_t sourcePort = 0;
+        std::uint16_t destinationPort = 0;
+        if (!ParsePort(fields[3], sourcePort) || !ParsePort(fields[4], destinationPort) ||
+            !ClientAddress::Parse(fields[1], sourcePort, out.source) ||
+            !ClientAddress::Parse(fields[2], destinationPort, out.destination) ||
+            out.source.IsIPv4() != (fields[0] == "TCP4")) {
+            return ProxyParseStatus::Invalid;
+        }
+        return ProxyParseStatus::Complete;
+    }
+
+    /**
+     * 12-byte signature, version/command, family/protocol, 16-bit length, addresses, TLVs (ignored)
+     */
+    inline ProxyParseStatus ParseV2(const UInt8* data, Size length, ProxyHeader& out) {
+        if (length < 16) return ProxyParseStatus::NeedMore;
+        const UInt8 versionCommand = data[12];
+        const UInt8 familyProtocol = data[13];
+        const Size payloadLength = (static_cast<Size>(data[14]) << 8) | data[15];
+        if ((versionCommand >> 4) != 2) return ProxyParseStatus::Invalid;
+        if (length < 16 + payloadLength) return ProxyParseStatus::NeedMore;
+
+        out = ProxyHeader();
+        out.length = 16 + payloadLength;
+        const UInt8 command = versionCommand & 0x0F;
+        if (command == 0x0) {
+            out.isLocal = true;
+            return ProxyParseStatus::Complete;
+        }
+        if (command != 0x1) return ProxyParseStatus::Invalid;
+
+        const UInt8* payload = data + 16;
+        const UInt8 family = familyProtocol >> 4;
+        if (family == 0x1 && payloadLength >= 12) {
+            out.source = ClientAddress::FromIPv4(payload, static_cast<std::uint16_t>((payload[8] << 8) | payload[9]));
+            out.destination = ClientAddress::FromIPv4(payload + 4, static_cast<std::uint16_t>((payload[10] << 8) | payload[11]));
+        } else if (family == 0x2 && payloadLength >= 36) {
+            out.source = ClientAddress::FromIPv6(payload, static_cast<std::uint16_t>((payload[32] << 8) | payload[33]));
+            out.destination = ClientAddress::FromIPv6(payload + 16, static_cast<std::uint16_t>((payload[34] << 8) | payload[35]));
+        } else if (family == 0x0 || family == 0x3) {
+            // AF_UNSPEC or AF_UNIX: no IP address to report
+            out.isLocal = true;
+        } else {
+            return ProxyParseStatus::Invalid;
+        }
+        return ProxyParseStatus::Complete;
+    }
+
+    /**
+     * Detect and parse a v1 or v2 preamble at the start of a connection
+     * @param data Bytes received so far
+     * @param length Number of bytes received
+     * @param out Parsed addresses when Complete is returned
+     */
+    inline ProxyParseStatus Parse(const char* data, Size length, ProxyHeader& out) {
+        const Size v2Prefix = length < sizeof(kV2Signature) ? length : sizeof(kV2Signature);
+        if (length > 0 && std::memcmp(data, kV2Signature, v2Prefix) == 0) {
+            if (length < sizeof(kV2Signature)) return ProxyParseStatus::NeedMore;
+            return ParseV2(reinterpret_cast<const UInt8*>(data), length, out);
+        }
+        const Size v1Prefix = length < 6 ? length : 6;
+        if (length > 0 && std::memcmp(data, "PROXY ", v1Prefix) == 0) {
+            if (length < 6) return ProxyParseStatus::NeedMore;
+            return ParseV1(data, length, out);
+        }
+        return ProxyParseStatus::NotProxy;
+    }
+}
+
+#endif // PROXYPROTOCOL_H
@@ -0,0 +1,355 @@
+#ifndef REACTORPLACEMENT_H
+#define REACTORPLACEMENT_H
+
+#include <StandardDefines.h>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_LINUX
+#include <cerrno>
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <cstring>
+#include <unistd.h>
+#endif
+
+/**
+ * CPU and NUMA placement of one reactor shard (its thread, buffer slabs and connection table)
+ */
+class ShardPlacement {
+
+    /**
+     * CPUs the shard's threads may run on; empty means no pinning
+     */
+    Public StdVector<UInt> cpus;
+
+    /**
+     * NUMA node to allocate the shard's memory on; -1 means first-touch on the pinned thread
+     */
+    Public int numaNode = -1;
+};
+
+/**
+ * Placement of all reactor shards of a sharded server
+ * Accepted by IServer::SetReactorPlacement(). Implementations pin each shard thread with
+ * CpuAffinity::PinCurrentThread(), allocate its slabs and tables from a NodeLocalRegion, and,
+ * when steerByIncomingCpu is set, hand each accepted connection to ShardForSocket(fd).
+ */
+class ReactorPlacement {
+
+    Public StdVector<ShardPlacement> shards;
+
+    /**
+     * Dispatch accepted connections to the shard owning the CPU that received them (SO_INCOMING_CPU)
+     */
+    Public Bool steerByIncomingCpu = false;
+
+    /**
+     * Shard whose CPU set contains cpu
+     * @return Shard index, or -1 if no shard lists the CPU
+     */
+    Public int ShardForCpu(int cpu) const {
+        if (cpu < 0) return -1;
+        for (Size shard = 0; shard < shards.size(); ++shard) {
+            for (UInt candidate : shards[shard].cpus) {
+                if (static_cast<int>(candidate) == cpu) return static_cast<int>(shard);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Shard for an accepted connection, chosen from the CPU that processed its packets
+     * @return Shard index, or -1 when steering is off or the CPU is unknown (fall back to round robin)
+     */
+    Public inline int ShardForSocket(int fd) const;
+
+    /**
+     * One shard per CPU the process may run on, each pinned to its CPU and allocating on that CPU's NUMA node
+     */
+    Public Static inline ReactorPlacement OneShardPerCpu();
+
+    /**
+     * One shard per NUMA node, each allowed on the CPUs of its node that the process may run on
+     */
+    Public Static inline ReactorPlacement OneShardPerNode();
+};
+
+/**
+ * Thread pinning and topology queries (Linux; no-ops returning false/-1 elsewhere)
+ */
+namespace CpuAffinity {
+
+    /**
+     * Parse a sysfs CPU list such as "0-3,8,10-11"
+     */
+    inline StdVector<UInt> ParseCpuList(const char* list) {
+        StdVector<UInt> cpus;
+        const char* cursor = list;
+        while (*cursor >= '0' && *cursor <= '9') {
+            char* end = nullptr;
+            const unsigned long first = std::strtoul(cursor, &end, 10);
+            unsigned long last = first;
+            if (*end == '-') last = std::strtoul(end + 1, &end, 10);
+            for (unsigned long cpu = first; cpu <= last && last - first < 65536; ++cpu) cpus.push_back(static_cast<UInt>(cpu));
+            cursor = *end == ',' ? end + 1 : end;
+        }
+        return cpus;
+    }
+
+    /**
+     * CPUs this process may run on, in ascending order
+     * Taken from the affinity mask, so offline CPUs and CPUs outside the process's cpuset
+     * (containers, taskset) are excluded; falls back to /sys/devices/system/cpu/online.
+     * @return At least one CPU id (0 when nothing can be determined)
+     */
+    inline StdVector<UInt> GetAllowedCpus() {
+        StdVector<UInt> cpus;
+#ifdef SERVERLIB_LINUX
+        // Size the mask for the configured CPUs; grow it if the kernel's mask is larger still
+        const long configured = ::sysconf(_SC_NPROCESSORS_CONF);
+        int setSize = configured > CPU_SETSIZE ? static_cast<int>(configured) : CPU_SETSIZE;
+        for (int attempt = 0; attempt < 4 && cpus.empty(); ++attempt, setSize *= 2) {
+            cpu_set_t* set = CPU_ALLOC(setSize);
+            if (set == nullptr) break;
+            const Size bytes = CPU_ALLOC_SIZE(setSize);
+            CPU_ZERO_S(bytes, set);
+            if (::sched_getaffinity(0, bytes, set) == 0) {
+                for (int cpu = 0; cpu < setSize; ++cpu) {
+                    if (CPU_ISSET_S(cpu, bytes, set)) cpus.push_back(static_cast<UInt>(cpu));
+                }
+                CPU_FREE(set);
+                break;
+            }
+            CPU_FREE(set);
+            if (errno != EINVAL) break;
+        }
+        if (cpus.empty()) {
+            if (std::FILE* file = std::fopen("/sys/devices/system/cpu/online", "r")) {
+                char list[1024] = {};
+                if (std::fgets(list, sizeof(list), file) != nullptr) cpus = ParseCpuList(list);
+                std::fclose(file);
+            }
+        }
+#endif
+        if (cpus.empty()) cpus.push_back(0);
+        return cpus;
+    }
+
+    /**
+     * Number of CPUs this process may run on (see GetAllowedCpus())
+     */
+    inline UInt GetCpuCount() {
+        return static_cast<UInt>(GetAllowedCpus().size());
+    }
+
+    /**
+     * Restrict the calling thread to a set of CPUs
+     * @return true if the affinity was applied
+     */
+    inline Bool PinCurrentThread(const StdVector<UInt>& cpus) {
+#ifdef SERVERLIB_LINUX
+        if (cpus.empty()) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (UInt cpu : cpus) {
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+
+    /**
+     * CPU the calling thread is currently running on, -1 if unknown
+     */
+    inline int GetCurrentCpu() {
+#ifdef SERVERLIB_LINUX
+        return ::sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+
+    /**
+     * NUMA node a CPU belongs to, read from sysfs
+     * @return Node number, or -1 if unknown (single-node machines report 0)
+     */
+    inline int GetNumaNodeOfCpu(UInt cpu) {
+#ifdef SERVERLIB_LINUX
+        char path[64];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+        DIR* directory = ::opendir(path);
+        if (directory == nullptr) return -1;
+        int node = -1;
+        while (dirent* entry = ::readdir(directory)) {
+            if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+                node = std::atoi(entry->d_name + 4);
+                break;
+            }
+        }
+        ::closedir(directory);
+        return node;
+#else
+        (void)cpu;
+        return -1;
+#endif
+    }
+
+    /**
+     * CPU that processed the most recent packets of a connected socket (SO_INCOMING_CPU)
+     * @return CPU number, or -1 if unsupported
+     */
+    inline int GetIncomingCpu(int fd) {
+#if defined(SERVERLIB_LINUX) && defined(SO_INCOMING_CPU)
+        int cpu = -1;
+        socklen_t length = sizeof(cpu);
+        if (::getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &length) != 0) return -1;
+        return cpu;
+#else
+        (void)fd;
+        return -1;
+#endif
+    }
+
+    /**
+     * Bind a SO_REUSEPORT listener to a CPU, so the kernel delivers connections received on that
+     * CPU to this listener (one listener per shard)
+     */
+    inline Bool SetIncomingCpu(int fd, int cpu) {
+#if defined(SERVERLIB_LINUX) && defined(SO_INCOMING_CPU)
+        return ::setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) == 0;
+#else
+        (void)fd;
+        (void)cpu;
+        return false;
+#endif
+    }
+}
+
+/**
+ * Anonymous memory placed on a NUMA node, for a shard's buffer slabs and connection table
+ * Uses mbind(MPOL_PREFERRED) when a node is given, then touches every page from the calling
+ * thread; when node is -1 the first touch alone places the pages (call from the pinned shard thread).
+ */
+class NodeLocalRegion {
+
+    Private void* data_;
+    Private Size size_;
+
+    Public NodeLocalRegion() : data_(nullptr), size_(0) {}
+
+    /**
+     * @param bytes Size of the region
+     * @param numaNode Node to place the pages on, or -1 for first-touch placement
+     */
+    Public NodeLocalRegion(Size bytes, int numaNode) : data_(nullptr), size_(0) {
+        Allocate(bytes, numaNode);
+    }
+
+    Public ~NodeLocalRegion() {
+        Release();
+    }
+
+    NodeLocalRegion(const NodeLocalRegion&) = delete;
+    NodeLocalRegion& operator=(const NodeLocalRegion&) = delete;
+
+    Public NodeLocalRegion(NodeLocalRegion&& other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    Public NodeLocalRegion& operator=(NodeLocalRegion&& other) noexcept {
+        if (this != &other) {
+            Release();
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    Public Bool Allocate(Size bytes, int numaNode) {
+        Release();
+        if (bytes == 0) return false;
+#ifdef SERVERLIB_LINUX
+        void* region = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) return false;
+#ifdef SYS_mbind
+        if (numaNode >= 0 && numaNode < static_cast<int>(sizeof(unsigned long) * 8)) {
+            // MPOL_PREFERRED: use the node while it has free memory, fall back instead of failing
+            const int mpolPreferred = 1;
+            unsigned long nodeMask = 1UL << numaNode;
+            ::syscall(SYS_mbind, region, bytes, mpolPreferred, &nodeMask, sizeof(nodeMask) * 8, 0);
+        }
+#else
+        (void)numaNode;
+#endif
+        // First touch faults every page in on the calling thread's node (or the mbind node)
+        std::memset(region, 0, bytes);
+        data_ = region;
+#else
+        (void)numaNode;
+        data_ = ::operator new(bytes, std::nothrow);
+        if (data_ == nullptr) return false;
+#endif
+        size_ = bytes;
+        return true;
+    }
+
+    Public Void Release() {
+        if (data_ == nullptr) return;
+#ifdef SERVERLIB_LINUX
+        ::munmap(data_, size_);
+#else
+        ::operator delete(data_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    Public void* GetData() const { return data_; }
+    Public Size GetSize() const { return size_; }
+};
+
+inline int ReactorPlacement::ShardForSocket(int fd) const {
+    if (!steerByIncomingCpu) return -1;
+    return ShardForCpu(CpuAffinity::GetIncomingCpu(fd));
+}
+
+inline ReactorPlacement ReactorPlacement::OneShardPerCpu() {
+    ReactorPlacement placement;
+    for (UInt cpu : CpuAffinity::GetAllowedCpus()) {
+        ShardPlacement shard;
+        shard.cpus.push_back(cpu);
+        shard.numaNode = CpuAffinity::GetNumaNodeOfCpu(cpu);
+        placement.shards.push_back(shard);
+    }
+    return placement;
+}
+
+inline ReactorPlacement ReactorPlacement::OneShardPerNode() {
+    ReactorPlacement placement;
+    for (UInt cpu : CpuAffinity::GetAllowedCpus()) {
+        const int node = CpuAffinity::GetNumaNodeOfCpu(cpu);
+        Size shard = 0;
+        while (shard < placement.shards.size() && placement.shards[shard].numaNode != node) ++shard;
+        if (shard == placement.shards.size()) {
+            ShardPlacement nodeShard;
+            nodeShard.numaNode = node;
+            placement.shards.push_back(nodeShard);
+        }
+        placement.shards[shard].cpus.push_back(cpu);
+    }
+    return placement;
+}
+
+#endif // REACTORPLACEMENT_H
@@ -0,0 +1,248 @@
+#ifndef REQUESTCOALESCER_H
+#define REQUESTCOALESCER_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "IHttpRequest.h"
+#include "IHttpResponse.h"
+
+/**
+ * One request's view of a response shared by coalesced requests
+ * Forwards every getter to the immutable shared response but carries its own request ID, so
+ * SetRequestId() or routing by GetRequestId() never touches another request's response.
+ */
+class SharedHttpResponse : public IHttpResponse {
+
+    Private std::shared_ptr<const IHttpResponse> shared_;
+    Private StdString requestId_;
+
+    Public SharedHttpResponse(std::shared_ptr<const IHttpResponse> shared, CStdString& requestId)
+        : shared_(std::move(shared)), requestId_(requestId) {}
+
+    Public Virtual CStdString& GetHttpVersion() const override { return shared_->GetHttpVersion(); }
+    Public Virtual UInt GetStatusCode() const override { return shared_->GetStatusCode(); }
+    Public Virtual CStdString& GetStatusMessage() const override { return shared_->GetStatusMessage(); }
+    Public Virtual StdString GetHeader(CStdString& name) const override { return shared_->GetHeader(name); }
+    Public Virtual const StdMap<StdString, StdString>& GetHeaders() const override { return shared_->GetHeaders(); }
+    Public Virtual Bool HasHeader(CStdString& name) const override { return shared_->HasHeader(name); }
+    Public Virtual CStdString& GetBody() const override { return shared_->GetBody(); }
+    Public Virtual const StdVector<UInt8>& GetBodyBytes() const override { return shared_->GetBodyBytes(); }
+    Public Virtual StdString GetContentType() const override { return shared_->GetContentType(); }
+    Public Virtual ULong GetContentLength() const override { return shared_->GetContentLength(); }
+    Public Virtual StdString GetSetCookie(CStdString& name) const override { return shared_->GetSetCookie(name); }
+    Public Virtual const StdMap<StdString, StdString>& GetSetCookies() const override { return shared_->GetSetCookies(); }
+    Public Virtual Bool HasSetCookie(CStdString& name) const override { return shared_->HasSetCookie(name); }
+    Public Virtual StdString GetLocation() const override { return shared_->GetLocation(); }
+    Public Virtual StdString GetServer() const override { return shared_->GetServer(); }
+    Public Virtual StdString GetDate() const override { return shared_->GetDate(); }
+    Public Virtual StdString GetLastModified() const override { return shared_->GetLastModified(); }
+    Public Virtual StdString GetETag() const override { return shared_->GetETag(); }
+    Public Virtual StdString GetCacheControl() const override { return shared_->GetCacheControl(); }
+    Public Virtual StdString GetExpires() const override { return shared_->GetExpires(); }
+    Public Virtual StdString GetAllow() const override { return shared_->GetAllow(); }
+    Public Virtual StdString GetWwwAuthenticate() const override { return shared_->GetWwwAuthenticate(); }
+    Public Virtual StdString GetContentEncoding() const override { return shared_->GetContentEncoding(); }
+    Public Virtual StdString GetContentLanguage() const override { return shared_->GetContentLanguage(); }
+    Public Virtual StdString GetContentDisposition() const override { return shared_->GetContentDisposition(); }
+    Public Virtual StdString GetContentRange() const override { return shared_->GetContentRange(); }
+    Public Virtual CStdString& GetRawResponse() const override { return shared_->GetRawResponse(); }
+    Public Virtual StdString ToHttpString() const override { return shared_->ToHttpString(); }
+    Public Virtual Bool HasBody() const override { return shared_->HasBody(); }
+    Public Virtual Bool IsSuccess() const override { return shared_->IsSuccess(); }
+    Public Virtual Bool IsRedirect() const override { return shared_->IsRedirect(); }
+    Public Virtual Bool IsClientError() const override { return shared_->IsClientError(); }
+    Public Virtual Bool IsServerError() const override { return shared_->IsServerError(); }
+    Public Virtual Bool IsJson() const override { return shared_->IsJson(); }
+    Public Virtual Bool IsHtml() const override { return shared_->IsHtml(); }
+    Public Virtual Bool IsXml() const override { return shared_->IsXml(); }
+    Public Virtual Bool IsText() const override { return shared_->IsText(); }
+    Public Virtual ULong GetTimestamp() const override { return shared_->GetTimestamp(); }
+
+    Public Virtual CStdString& GetRequestId() const override {
+        return const_cast<CStdString&>(reinterpret_cast<const CStdString&>(requestId_));
+    }
+
+    Public Virtual Void SetRequestId(CStdString& requestId) override {
+        requestId_ = StdString(requestId);
+    }
+
+    /**
+     * The response shared with the other coalesced requests
+     */
+    Public const std::shared_ptr<const IHttpResponse>& GetShared() const {
+        return shared_;
+    }
+};
+
+/**
+ * Singleflight coalescing of identical concurrent GET/HEAD requests
+ * The first request for a key runs the handler; identical requests arriving while it runs wait for
+ * its result instead of running the handler again. The handler's response is shared read-only:
+ * Handle() gives each request a SharedHttpResponse carrying its own request ID, and
+ * HandleSerialized() gives every request the same buffer, serialized once on first use. Requests
+ * are identical when method, path, query and the values of the vary headers match. Authorization
+ * and Cookie are vary headers by default, so one user's response is never handed to another.
+ * Other methods pass straight through.
+ *
+ *   RequestCoalescer coalescer;
+ *   MiddlewarePipeline<BearerAuthStage, RequestCoalescer&> pipeline(auth, coalescer);   // as a stage
+ *
+ *   std::shared_ptr<const StdString> bytes = coalescer.HandleSerialized(request, handler);   // or directly
+ *   sender.SendAll(bytes);                                                                 // e.g. ZeroCopySender
+ */
+class RequestCoalescer {
+
+    /**
+     * Outcome of one handler run, shared by every coalesced request
+     */
+    Private class Result {
+        // Never modified once published; nullptr if the handler returned no response
+        Public std::shared_ptr<const IHttpResponse> response;
+        Public std::once_flag serializeOnce;
+        // Set by the first HandleSerialized() caller
+        Public std::shared_ptr<const StdString> serialized;
+    };
+
+    Private std::mutex mutex_;
+    Private std::unordered_map<StdString, std::shared_future<std::shared_ptr<Result>>> inFlight_;
+    Private StdVector<StdString> varyHeaders_;
+    Private std::atomic<ULong> executions_;
+    Private std::atomic<ULong> coalesced_;
+
+    /**
+     * Key identifying identical requests, or an empty string if the request must not be coalesced
+     */
+    Private StdString MakeKey(const IHttpRequest& request) const {
+        if (!request.IsMethod(HttpMethod::GET) && !request.IsMethod(HttpMethod::HEAD)) return StdString();
+        StdString key;
+        key.reserve(request.GetFullUrl().size() + 64);
+        key += request.IsMethod(HttpMethod::GET) ? "GET " : "HEAD ";
+        key += request.GetFullUrl();
+        for (CStdString& header : varyHeaders_) {
+            // Header values cannot contain a newline, so it separates the parts unambiguously
+            key += '\n';
+            key += request.GetHeader(header);
+        }
+        return key;
+    }
+
+    Private Static std::shared_ptr<const StdString> Serialize(Result& result) {
+        std::call_once(result.serializeOnce, [&result]() {
+            if (result.response != nullptr) {
+                result.serialized = std::make_shared<const StdString>(result.response->ToHttpString());
+            }
+        });
+        return result.serialized;
+    }
+
+    /**
+     * Run handler for a coalescible request, or wait for an identical request already running it
+     * Exceptions thrown by the handler are rethrown in every coalesced request.
+     */
+    template<typename Handler>
+    std::shared_ptr<Result> Execute(const StdString& key, const IHttpRequestPtr& request, Handler& handler) {
+        std::promise<std::shared_ptr<Result>> promise;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto found = inFlight_.find(key);
+            if (found != inFlight_.end()) {
+                std::shared_future<std::shared_ptr<Result>> pending = found->second;
+                lock.unlock();
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+                return pending.get();
+            }
+            inFlight_.emplace(key, promise.get_future().share());
+        }
+        executions_.fetch_add(1, std::memory_order_relaxed);
+
+        std::shared_ptr<Result> result = std::make_shared<Result>();
+        try {
+            result->response = handler(request);
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                inFlight_.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        {
+            // Unpublish first: requests arriving from now on start a fresh run instead of getting this result
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight_.erase(key);
+        }
+        promise.set_value(result);
+        return result;
+    }
+
+    /**
+     * @param varyHeaders Headers whose values must also match for requests to be coalesced
+     */
+    Public explicit RequestCoalescer(StdVector<StdString> varyHeaders = { "Accept", "Accept-Encoding", "Authorization", "Cookie" })
+        : varyHeaders_(std::move(varyHeaders)), executions_(0), coalesced_(0) {}
+
+    RequestCoalescer(const RequestCoalescer&) = delete;
+    RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+    /**
+     * Middleware stage: the rest of the chain runs once per group of identical requests
+     * @return The handler's response as this request's SharedHttpResponse; requests that are not
+     *         coalesced get the handler's response unchanged
+     */
+    template<typename Next>
+    IHttpResponsePtr Handle(const IHttpRequestPtr& request, Next&& next) {
+        const StdString key = MakeKey(*request);
+        if (key.empty()) {
+            executions_.fetch_add(1, std::memory_order_relaxed);
+            return next(request);
+        }
+        std::shared_ptr<Result> result = Execute(key, request, next);
+        if (result->response == nullptr) return nullptr;
+        return std::make_shared<SharedHttpResponse>(result->response, request->GetRequestId());
+    }
+
+    /**
+     * Like Handle(), returning the serialized response for writing to the socket
+     * Coalesced requests share one buffer, serialized by the first of them to ask.
+     * @param handler Callable IHttpResponsePtr(const IHttpRequestPtr&)
+     * @return nullptr if the handler returned no response
+     */
+    template<typename Handler>
+    std::shared_ptr<const StdString> HandleSerialized(const IHttpRequestPtr& request, Handler&& handler) {
+        const StdString key = MakeKey(*request);
+        if (key.empty()) {
+            executions_.fetch_add(1, std::memory_order_relaxed);
+            IHttpResponsePtr response = handler(request);
+            if (response == nullptr) return nullptr;
+            return std::make_shared<const StdString>(response->ToHttpString());
+        }
+        return Serialize(*Execute(key, request, handler));
+    }
+
+    /**
+     * Number of handler runs
+     */
+    Public ULong GetExecutionCount() const {
+        return executions_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Number of requests answered with another request's result
+     */
+    Public ULong GetCoalescedCount() const {
+        return coalesced_.load(std::memory_order_relaxed);
+    }
+
+    Public Size GetInFlightCount() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return inFlight_.size();
+    }
+};
+
+#endif // REQUESTCOALESCER_H
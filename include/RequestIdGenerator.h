@@ -0,0 +1,199 @@
+#ifndef REQUESTIDGENERATOR_H
+#define REQUESTIDGENERATOR_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A 128-bit, time-ordered request ID (UUIDv7 layout)
+ * Holds the binary value; the 36-character string form is formatted into an inline buffer the
+ * first time it is requested, so IDs that are only compared or hashed never touch a string.
+ */
+class RequestId {
+
+    Public Static constexpr Size kStringLength = 36;
+
+    Private std::uint64_t high_;
+    Private std::uint64_t low_;
+    Private mutable char text_[kStringLength];
+    Private mutable Bool formatted_;
+
+    Private Void Format() const {
+        static const char kHex[] = "0123456789abcdef";
+        char* out = text_;
+        for (int nibble = 15; nibble >= 0; --nibble) {
+            *out++ = kHex[(high_ >> (nibble * 4)) & 0xF];
+            if (nibble == 8 || nibble == 4) *out++ = '-';
+        }
+        *out++ = '-';
+        for (int nibble = 15; nibble >= 0; --nibble) {
+            *out++ = kHex[(low_ >> (nibble * 4)) & 0xF];
+            if (nibble == 12) *out++ = '-';
+        }
+        formatted_ = true;
+    }
+
+    Public RequestId() : high_(0), low_(0), formatted_(false) {}
+
+    Public RequestId(std::uint64_t high, std::uint64_t low) : high_(high), low_(low), formatted_(false) {}
+
+    Public RequestId(const RequestId& other) : high_(other.high_), low_(other.low_), formatted_(false) {}
+
+    Public RequestId& operator=(const RequestId& other) {
+        high_ = other.high_;
+        low_ = other.low_;
+        formatted_ = false;
+        return *this;
+    }
+
+    Public std::uint64_t GetHigh() const { return high_; }
+    Public std::uint64_t GetLow() const { return low_; }
+
+    /**
+     * Milliseconds since the Unix epoch at which the ID was generated
+     */
+    Public std::uint64_t GetTimestampMs() const {
+        return high_ >> 16;
+    }
+
+    /**
+     * Canonical 8-4-4-4-12 form; valid for the lifetime of this object
+     */
+    Public std::string_view ToStringView() const {
+        if (!formatted_) Format();
+        return std::string_view(text_, kStringLength);
+    }
+
+    Public StdString ToString() const {
+        return StdString(ToStringView());
+    }
+
+    Public Bool operator==(const RequestId& other) const {
+        return high_ == other.high_ && low_ == other.low_;
+    }
+
+    Public Bool operator!=(const RequestId& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * Orders by generation time (then by per-thread sequence)
+     */
+    Public Bool operator<(const RequestId& other) const {
+        return high_ != other.high_ ? high_ < other.high_ : low_ < other.low_;
+    }
+};
+
+/**
+ * Lock-free generator of UUIDv7 request IDs
+ * Each thread keeps its own splitmix64 state and last timestamp, so generation takes no locks and
+ * no syscalls beyond the vDSO clock read. IDs from one thread are strictly increasing (a 12-bit
+ * sequence in rand_a orders IDs within the same millisecond); 62 random bits keep threads and
+ * processes apart. A fork() child would inherit the forking thread's state and repeat its parent's
+ * IDs, so a pthread_atfork() handler bumps a fork generation and the copied state reseeds on its
+ * next use.
+ *
+ *   RequestId id = RequestIdGenerator::Next();
+ *   StdString text = RequestIdGenerator::NextString();
+ */
+class RequestIdGenerator {
+
+    /**
+     * Incremented in every fork() child; a ThreadState seeded under another generation reseeds
+     */
+    Private Static std::atomic<ULong>& GetForkGeneration() {
+        static std::atomic<ULong> generation{ 0 };
+        return generation;
+    }
+
+    Private Static Void RegisterForkHandler() {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        static const int registered = ::pthread_atfork(nullptr, nullptr, []() {
+            GetForkGeneration().fetch_add(1, std::memory_order_relaxed);
+        });
+        (void)registered;
+#endif
+    }
+
+    Private class ThreadState {
+        Public std::uint64_t random;
+        Public std::uint64_t lastMs = 0;
+        Public UInt sequence = 0;
+        Public ULong forkGeneration = 0;
+
+        Public ThreadState() {
+            RegisterForkHandler();
+            Seed();
+        }
+
+        /**
+         * Seed from the clock, the process, the thread and this state's address; no /dev/urandom read
+         */
+        Public Void Seed() {
+            forkGeneration = GetForkGeneration().load(std::memory_order_relaxed);
+            const std::uint64_t clock = static_cast<std::uint64_t>(
+                std::chrono::high_resolution_clock::now().time_since_epoch().count());
+            const std::uint64_t thread = static_cast<std::uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+            std::uint64_t process = 0;
+#ifdef SERVERLIB_POSIX_SOCKETS
+            process = static_cast<std::uint64_t>(::getpid());
+#endif
+            random = clock ^ (thread << 17) ^ (process << 41) ^ reinterpret_cast<std::uintptr_t>(this);
+        }
+
+        Public std::uint64_t NextRandom() {
+            std::uint64_t z = (random += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+    };
+
+    Private Static ThreadState& GetThreadState() {
+        thread_local ThreadState state;
+        if (state.forkGeneration != GetForkGeneration().load(std::memory_order_relaxed)) state.Seed();
+        return state;
+    }
+
+    Public Static RequestId Next() {
+        ThreadState& state = GetThreadState();
+        std::uint64_t nowMs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        if (nowMs <= state.lastMs) {
+            // Same millisecond (or the clock stepped back): keep ordering with the sequence
+            nowMs = state.lastMs;
+            if (++state.sequence > 0xFFF) {
+                ++nowMs;
+                state.sequence = 0;
+            }
+        } else {
+            // Start each millisecond at a random sequence in the lower half, leaving room to count up
+            state.sequence = static_cast<UInt>(state.NextRandom() & 0x7FF);
+        }
+        state.lastMs = nowMs;
+
+        const std::uint64_t high = ((nowMs & 0xFFFFFFFFFFFFULL) << 16) | (0x7ULL << 12) | state.sequence;
+        const std::uint64_t low = (state.NextRandom() & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+        return RequestId(high, low);
+    }
+
+    /**
+     * Next ID in string form, for APIs that take the request ID as StdString
+     */
+    Public Static StdString NextString() {
+        return Next().ToString();
+    }
+};
+
+#endif // REQUESTIDGENERATOR_H
@@ -0,0 +1,773 @@
+#ifndef REVERSEPROXY_H
+#define REVERSEPROXY_H
+
+#include <StandardDefines.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include "HttpClient.h"
+#include "HttpMethod.h"
+#include "IHttpRequest.h"
+#include "IHttpResponse.h"
+#include "LatencyHistogram.h"
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Header rewriting shared by both forwarding paths of ReverseProxy
+ */
+namespace ProxyHeaders {
+
+    inline StdString ToLower(CStdString& value) {
+        StdString lower(value);
+        for (char& c : lower) c = static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+        return lower;
+    }
+
+    /**
+     * Whether a header applies to one connection only and must not be forwarded (RFC 9110 section 7.6.1)
+     * @param lowerName Header name in lower case
+     * @param lowerConnection Value of the message's Connection header in lower case; it can name more such headers
+     */
+    inline Bool IsHopByHop(CStdString& lowerName, CStdString& lowerConnection) {
+        if (lowerName == "connection" || lowerName == "keep-alive" || lowerName == "proxy-connection" ||
+            lowerName == "te" || lowerName == "trailer" || lowerName == "transfer-encoding" ||
+            lowerName == "upgrade" || lowerName == "proxy-authorization" || lowerName == "proxy-authenticate") {
+            return true;
+        }
+        Size start = 0;
+        while (start < lowerConnection.length()) {
+            Size end = lowerConnection.find(',', start);
+            if (end == StdString::npos) end = lowerConnection.length();
+            Size tokenStart = lowerConnection.find_first_not_of(" \t", start);
+            Size tokenEnd = end;
+            while (tokenEnd > tokenStart && (lowerConnection[tokenEnd - 1] == ' ' || lowerConnection[tokenEnd - 1] == '\t')) --tokenEnd;
+            if (tokenStart < tokenEnd && lowerConnection.compare(tokenStart, tokenEnd - tokenStart, lowerName) == 0 &&
+                tokenEnd - tokenStart == lowerName.length()) {
+                return true;
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+
+    /**
+     * Value of a header looked up case-insensitively
+     */
+    inline StdString Find(const StdMap<StdString, StdString>& headers, const char* lowerName) {
+        for (const auto& header : headers) {
+            if (ToLower(header.first) == lowerName) return header.second;
+        }
+        return StdString();
+    }
+
+    /**
+     * Headers to send upstream: end-to-end headers of the client request plus X-Forwarded-*
+     * Expect is dropped: the proxy answers 100-continue itself (see ReverseProxy::Stream()), and the
+     * upstream receives the body right after the head.
+     * @param upstreamHost Replaces Host unless empty (the client's Host is kept then)
+     */
+    inline StdMap<StdString, StdString> ForRequest(const IHttpRequest& request, CStdString& upstreamHost) {
+        const StdMap<StdString, StdString>& headers = request.GetHeaders();
+        const StdString connection = ToLower(Find(headers, "connection"));
+        StdMap<StdString, StdString> forwarded;
+        StdString forwardedFor;
+        Bool hasProto = false;
+        for (const auto& header : headers) {
+            const StdString lowerName = ToLower(header.first);
+            if (IsHopByHop(lowerName, connection) || lowerName == "content-length" || lowerName == "expect") continue;
+            if (lowerName == "x-forwarded-for") {
+                forwardedFor = header.second;
+                continue;
+            }
+            if (lowerName == "host") {
+                forwarded["X-Forwarded-Host"] = header.second;
+                if (!upstreamHost.empty()) continue;
+            }
+            if (lowerName == "x-forwarded-proto") hasProto = true;
+            forwarded[header.first] = header.second;
+        }
+        if (!upstreamHost.empty()) forwarded["Host"] = upstreamHost;
+        CStdString& clientIp = request.GetClientIp();
+        if (!clientIp.empty()) forwardedFor = forwardedFor.empty() ? clientIp : forwardedFor + ", " + clientIp;
+        if (!forwardedFor.empty()) forwarded["X-Forwarded-For"] = forwardedFor;
+        if (!hasProto) forwarded["X-Forwarded-Proto"] = "http";
+        return forwarded;
+    }
+}
+
+/**
+ * Moves bytes between two sockets without copying them through user space
+ * On Linux the bytes go socket -> pipe -> socket with splice(); elsewhere, or if splice() is not
+ * supported for the descriptors, through a buffer. Each thread keeps one pipe.
+ */
+namespace ProxySplice {
+
+    inline int RemainingMs(std::chrono::steady_clock::time_point deadline) {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        return left > 0 ? static_cast<int>(left) : 0;
+    }
+
+    inline Bool WaitFor(int fd, short events, std::chrono::steady_clock::time_point deadline) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        pollfd entry{ fd, events, 0 };
+        return ::poll(&entry, 1, RemainingMs(deadline)) == 1;
+#else
+        (void)fd; (void)events; (void)deadline;
+        return false;
+#endif
+    }
+
+    /**
+     * Write a buffer completely (the buffered head, or body bytes read together with it)
+     */
+    inline Bool WriteAll(int fd, const char* data, Size length, std::chrono::steady_clock::time_point deadline) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+        const int flags = MSG_DONTWAIT;
+#endif
+        Size offset = 0;
+        while (offset < length) {
+            const ssize_t sent = ::send(fd, data + offset, length - offset, flags);
+            if (sent > 0) {
+                offset += static_cast<Size>(sent);
+            } else if (sent < 0 && errno == EINTR) {
+                continue;
+            } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!WaitFor(fd, POLLOUT, deadline)) return false;
+            } else {
+                return false;
+            }
+        }
+        return true;
+#else
+        (void)fd; (void)data; (void)length; (void)deadline;
+        return false;
+#endif
+    }
+
+    /**
+     * Copy through a user-space buffer
+     * @param length Bytes to move; ULong max moves until the source reaches end of stream
+     * @return Bytes moved, or -1 on error/timeout (or end of stream before length bytes)
+     */
+    inline long long CopyBytes(int from, int to, ULong length, std::chrono::steady_clock::time_point deadline) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        const Bool untilEof = length == static_cast<ULong>(-1);
+        char buffer[16 * 1024];
+        ULong moved = 0;
+        while (untilEof || moved < length) {
+            const Size want = untilEof || length - moved > sizeof(buffer) ? sizeof(buffer) : static_cast<Size>(length - moved);
+            const ssize_t count = ::recv(from, buffer, want, MSG_DONTWAIT);
+            if (count > 0) {
+                if (!WriteAll(to, buffer, static_cast<Size>(count), deadline)) return -1;
+                moved += static_cast<ULong>(count);
+            } else if (count == 0) {
+                return untilEof ? static_cast<long long>(moved) : -1;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!WaitFor(from, POLLIN, deadline)) return -1;
+            } else {
+                return -1;
+            }
+        }
+        return static_cast<long long>(moved);
+#else
+        (void)from; (void)to; (void)length; (void)deadline;
+        return -1;
+#endif
+    }
+
+#ifdef SERVERLIB_LINUX
+    /**
+     * This thread's pipe for splice(); recreated after an error may have left bytes in it
+     */
+    class ThreadPipe {
+        Public int readEnd = -1;
+        Public int writeEnd = -1;
+
+        Public Bool Open() {
+            if (readEnd >= 0) return true;
+            int fds[2];
+            if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) return false;
+            readEnd = fds[0];
+            writeEnd = fds[1];
+            return true;
+        }
+
+        Public Void Close() {
+            if (readEnd >= 0) ::close(readEnd);
+            if (writeEnd >= 0) ::close(writeEnd);
+            readEnd = writeEnd = -1;
+        }
+
+        Public ~ThreadPipe() {
+            Close();
+        }
+    };
+
+    inline ThreadPipe& GetThreadPipe() {
+        thread_local ThreadPipe pipe;
+        return pipe;
+    }
+#endif
+
+    /**
+     * Move length bytes (or everything until end of stream for ULong max) from one socket to another
+     * @return Bytes moved, or -1 on error/timeout (or end of stream before length bytes)
+     */
+    inline long long Transfer(int from, int to, ULong length, std::chrono::steady_clock::time_point deadline) {
+#ifdef SERVERLIB_LINUX
+        ThreadPipe& pipe = GetThreadPipe();
+        if (!pipe.Open()) return CopyBytes(from, to, length, deadline);
+        const Bool untilEof = length == static_cast<ULong>(-1);
+        const Size kStep = 64 * 1024;
+        ULong moved = 0;
+        Size inPipe = 0;
+        Bool sourceDone = false;
+        while (untilEof ? !(sourceDone && inPipe == 0) : moved < length) {
+            if (inPipe == 0 && !sourceDone) {
+                const Size want = untilEof || length - moved > kStep ? kStep : static_cast<Size>(length - moved);
+                const ssize_t count = ::splice(from, nullptr, pipe.writeEnd, nullptr, want, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (count > 0) {
+                    inPipe = static_cast<Size>(count);
+                } else if (count == 0) {
+                    if (!untilEof) break;
+                    sourceDone = true;
+                } else if (errno == EINTR) {
+                    continue;
+                } else if (errno == EAGAIN) {
+                    if (!WaitFor(from, POLLIN, deadline)) break;
+                } else if (errno == EINVAL && moved == 0) {
+                    // Descriptors that cannot be spliced
+                    return CopyBytes(from, to, length, deadline);
+                } else {
+                    break;
+                }
+                continue;
+            }
+            const ssize_t count = ::splice(pipe.readEnd, nullptr, to, nullptr, inPipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (count > 0) {
+                inPipe -= static_cast<Size>(count);
+                moved += static_cast<ULong>(count);
+            } else if (count < 0 && errno == EINTR) {
+                continue;
+            } else if (count < 0 && errno == EAGAIN) {
+                if (!WaitFor(to, POLLOUT, deadline)) break;
+            } else {
+                break;
+            }
+        }
+        if (inPipe != 0 || (!untilEof && moved < length)) {
+            pipe.Close();
+            return -1;
+        }
+        return static_cast<long long>(moved);
+#else
+        return CopyBytes(from, to, length, deadline);
+#endif
+    }
+
+    /**
+     * Relay both directions between two sockets until either side closes or nothing moves for idleTimeoutMs
+     * For upgraded connections (WebSocket) and CONNECT tunnels.
+     */
+    inline Void Tunnel(int first, int second, int idleTimeoutMs) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        char buffer[16 * 1024];
+        while (true) {
+            pollfd entries[2] = { { first, POLLIN, 0 }, { second, POLLIN, 0 } };
+            if (::poll(entries, 2, idleTimeoutMs) <= 0) return;
+            for (int side = 0; side < 2; ++side) {
+                if ((entries[side].revents & (POLLIN | POLLHUP | POLLERR)) == 0) continue;
+                const int from = side == 0 ? first : second;
+                const int to = side == 0 ? second : first;
+                const ssize_t count = ::recv(from, buffer, sizeof(buffer), MSG_DONTWAIT);
+                if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+                if (count <= 0) return;
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(idleTimeoutMs);
+                if (!WriteAll(to, buffer, static_cast<Size>(count), deadline)) return;
+            }
+        }
+#else
+        (void)first; (void)second; (void)idleTimeoutMs;
+#endif
+    }
+}
+
+/**
+ * Result of ReverseProxy::Stream()
+ */
+enum class ProxyStreamStatus {
+    KeepAlive,      // Response forwarded; the client connection can carry the next request
+    Close,          // Response forwarded; close the client connection
+    Failed          // No final response was sent to the client (at most interim 1xx ones); answer 502 (or close)
+};
+
+/**
+ * Gateway forwarding requests to upstream services by path prefix
+ * Two forwarding paths share the routes, connection pools and metrics:
+ * - Forward() / Handle(): for servers that deliver complete IHttpRequest objects. The upstream
+ *   response is parsed once and returned as-is (hop-by-hop headers removed); the body is not copied
+ *   or re-serialized on the way.
+ * - Stream(): for server implementations that own the client socket and have read only the request
+ *   head. Bodies framed by Content-Length move in both directions with splice(); chunked response
+ *   bodies are relayed as they arrive.
+ * Only hop-by-hop headers, Host (optional) and X-Forwarded-For/-Host/-Proto are rewritten.
+ * Routes are configured before serving; forwarding is thread-safe.
+ *
+ *   ReverseProxy proxy;
+ *   proxy.AddRoute("/api/users", "127.0.0.1", 8081);
+ *   proxy.AddRoute("/", "127.0.0.1", 8080);
+ *   MiddlewarePipeline<ReverseProxy&> pipeline(proxy);   // or: response = proxy.Forward(request);
+ */
+class ReverseProxy {
+
+    /**
+     * One upstream service and its metrics
+     */
+    Public class Route {
+        Public StdString prefix;
+        Public StdString host;
+        Public UInt port = 0;
+        // Request sent to response head received, in microseconds
+        Public LatencyHistogram latency;
+        Public std::atomic<ULong> requests{ 0 };
+        Public std::atomic<ULong> failures{ 0 };
+    };
+
+    Private StdVector<std::unique_ptr<Route>> routes_;
+    Private HttpClient client_;
+    Private Bool preserveHost_;
+    Private int timeoutMs_;
+
+    Private Static ULong MicrosSince(std::chrono::steady_clock::time_point start) {
+        return static_cast<ULong>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    Private StdString UpstreamHostHeader(const Route& route) const {
+        return preserveHost_ ? StdString() : route.host + ":" + std::to_string(route.port);
+    }
+
+    Private Static IHttpResponsePtr BadGateway(const IHttpRequest& request) {
+        return std::make_shared<SimpleHttpResponse>(request.GetRequestId(), 502,
+            SimpleHttpResponse::GetStatusMessageForCode(502),
+            StdMap<StdString, StdString>{ { "Content-Type", "text/plain" } }, StdString("Bad Gateway"));
+    }
+
+    /**
+     * Request head for the upstream, ending with the blank line
+     */
+    Private StdString SerializeHead(const IHttpRequest& request, const Route& route, ULong bodyLength) const {
+        StdString head = MethodToString(request.GetMethod());
+        head += ' ';
+        head += request.GetFullUrl();
+        head += " HTTP/1.1\r\n";
+        for (const auto& header : ProxyHeaders::ForRequest(request, UpstreamHostHeader(route))) {
+            head += header.first;
+            head += ": ";
+            head += header.second;
+            head += "\r\n";
+        }
+        if (bodyLength > 0 || request.IsMethod(HttpMethod::POST) || request.IsMethod(HttpMethod::PUT)) {
+            head += "Content-Length: ";
+            head += std::to_string(bodyLength);
+            head += "\r\n";
+        }
+        head += "\r\n";
+        return head;
+    }
+
+    /**
+     * Whether a response head is an interim 1xx response that precedes the final one
+     * 101 is excluded: after it the connection no longer carries HTTP/1.1.
+     */
+    Private Static Bool IsInterimHead(CStdString& head) {
+        const Size space = head.find(' ');
+        if (space == StdString::npos) return false;
+        const int statusCode = std::atoi(head.c_str() + space + 1);
+        return statusCode >= 100 && statusCode < 200 && statusCode != 101;
+    }
+
+    /**
+     * Response head for the client: hop-by-hop lines dropped except the framing we relay unchanged
+     * Content-Length is dropped under chunked coding (Transfer-Encoding overrides it, RFC 9112 section
+     * 6.3) and sent once if repeated.
+     * @param chunked Set if the body uses chunked transfer coding (Transfer-Encoding is kept then)
+     * @param contentLength Set to the Content-Length value, or ULong max if absent
+     * @param keepAlive Set to whether the upstream connection stays open after the body
+     * @return The head, or empty if Content-Length is not a number or repeated with different values
+     */
+    Private Static StdString RewriteResponseHead(CStdString& head, Bool& chunked, ULong& contentLength, Bool& keepAlive, UInt& statusCode) {
+        chunked = false;
+        contentLength = static_cast<ULong>(-1);
+        StdString connection;
+        StdString out;
+        out.reserve(head.length());
+        Size lineStart = 0;
+        Bool statusLine = true;
+        Bool http10 = false;
+        StdVector<std::pair<StdString, Size>> lines;
+        while (lineStart < head.length()) {
+            Size lineEnd = head.find('\n', lineStart);
+            if (lineEnd == StdString::npos) lineEnd = head.length();
+            Size contentEnd = lineEnd > lineStart && head[lineEnd - 1] == '\r' ? lineEnd - 1 : lineEnd;
+            const StdString line = head.substr(lineStart, contentEnd - lineStart);
+            lineStart = lineEnd + 1;
+            if (line.empty()) break;
+            if (statusLine) {
+                statusLine = false;
+                http10 = line.compare(0, 8, "HTTP/1.0") == 0;
+                const Size space = line.find(' ');
+                statusCode = space == StdString::npos ? 0 : static_cast<UInt>(std::atoi(line.c_str() + space + 1));
+                out += line;
+                out += "\r\n";
+                continue;
+            }
+            const Size colon = line.find(':');
+            if (colon == StdString::npos) continue;
+            const StdString lowerName = ProxyHeaders::ToLower(line.substr(0, colon));
+            const Size valueStart = line.find_first_not_of(" \t", colon + 1);
+            const StdString value = valueStart == StdString::npos ? StdString() : line.substr(valueStart);
+            if (lowerName == "connection") connection = ProxyHeaders::ToLower(value);
+            if (lowerName == "transfer-encoding") chunked = ProxyHeaders::ToLower(value).find("chunked") != StdString::npos;
+            if (lowerName == "content-length") {
+                const Size valueEnd = value.find_last_not_of(" \t") + 1;
+                if (valueEnd == 0) return StdString();
+                ULong parsed = 0;
+                for (Size i = 0; i < valueEnd; ++i) {
+                    const char c = value[i];
+                    if (c < '0' || c > '9') return StdString();
+                    const ULong next = parsed * 10 + static_cast<ULong>(c - '0');
+                    if (next / 10 != parsed) return StdString();
+                    parsed = next;
+                }
+                if (contentLength != static_cast<ULong>(-1) && parsed != contentLength) return StdString();
+                contentLength = parsed;
+            }
+            lines.emplace_back(lowerName, out.length());
+            out += line;
+            out += "\r\n";
+        }
+        keepAlive = connection.find("close") == StdString::npos && (!http10 || connection.find("keep-alive") != StdString::npos);
+
+        // Second pass: drop the hop-by-hop lines now that the Connection header is known
+        StdString filtered;
+        filtered.reserve(out.length() + 2);
+        Size previous = 0;
+        Bool contentLengthSent = false;
+        for (const auto& line : lines) {
+            filtered.append(out, previous, line.second - previous);
+            const Size end = out.find("\r\n", line.second) + 2;
+            Bool keep = !ProxyHeaders::IsHopByHop(line.first, connection) || (chunked && line.first == "transfer-encoding");
+            if (line.first == "content-length") {
+                keep = keep && !chunked && !contentLengthSent;
+                contentLengthSent = contentLengthSent || keep;
+            }
+            if (keep) filtered.append(out, line.second, end - line.second);
+            previous = end;
+        }
+        filtered.append(out, previous, StdString::npos);
+        filtered += "\r\n";
+        return filtered;
+    }
+
+    /**
+     * Relay a chunked body verbatim until its last chunk and trailers have passed
+     * @param buffered Body bytes already read together with the head
+     * @param clean Set to false if the upstream sent bytes after the body (its connection is then not reused)
+     */
+    Private Static Bool RelayChunked(int upstreamFd, int clientFd, StdString buffered, std::chrono::steady_clock::time_point deadline, Bool& clean) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        // Tracks the chunk framing to find the end of the body; bytes themselves are passed on unchanged
+        enum class Step { ChunkSize, Data, DataEnd, Trailer } step = Step::ChunkSize;
+        StdString line;
+        ULong remaining = 0;
+        char buffer[16 * 1024];
+        while (true) {
+            Bool finished = false;
+            Size index = 0;
+            while (index < buffered.length() && !finished) {
+                if (step == Step::Data) {
+                    const Size take = std::min<ULong>(remaining, buffered.length() - index);
+                    index += take;
+                    remaining -= take;
+                    if (remaining == 0) step = Step::DataEnd;
+                    continue;
+                }
+                const char c = buffered[index++];
+                if (c != '\n') {
+                    line += c;
+                    continue;
+                }
+                if (step == Step::ChunkSize) {
+                    remaining = std::strtoull(line.c_str(), nullptr, 16);
+                    step = remaining == 0 ? Step::Trailer : Step::Data;
+                } else if (step == Step::DataEnd) {
+                    step = Step::ChunkSize;
+                } else if (line.empty() || line == "\r") {
+                    finished = true;
+                }
+                line.clear();
+            }
+            if (!ProxySplice::WriteAll(clientFd, buffered.data(), index, deadline)) return false;
+            if (finished) {
+                clean = index == buffered.length();
+                return true;
+            }
+            const ssize_t count = ::recv(upstreamFd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (count > 0) {
+                buffered.assign(buffer, static_cast<Size>(count));
+            } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                buffered.clear();
+                if (!ProxySplice::WaitFor(upstreamFd, POLLIN, deadline)) return false;
+            } else {
+                return false;
+            }
+        }
+#else
+        (void)upstreamFd; (void)clientFd; (void)buffered; (void)deadline; (void)clean;
+        return false;
+#endif
+    }
+
+    /**
+     * @param timeoutMs Deadline for each forwarded request, from connect to the last response byte
+     * @param preserveHost Forward the client's Host header (true) or use the upstream's host:port
+     */
+    Public explicit ReverseProxy(int timeoutMs = 30000, Bool preserveHost = true)
+        : client_(timeoutMs), preserveHost_(preserveHost), timeoutMs_(timeoutMs) {}
+
+    ReverseProxy(const ReverseProxy&) = delete;
+    ReverseProxy& operator=(const ReverseProxy&) = delete;
+
+    /**
+     * Forward requests under prefix to host:port (longest prefix wins)
+     * The prefix matches whole path segments: "/api" matches "/api" and "/api/users" but not "/apix".
+     * Call before serving requests.
+     */
+    Public Void AddRoute(CStdString& prefix, CStdString& host, UInt port) {
+        std::unique_ptr<Route> route(new Route());
+        route->prefix = prefix;
+        route->host = host;
+        route->port = port;
+        routes_.push_back(std::move(route));
+        std::stable_sort(routes_.begin(), routes_.end(), [](const std::unique_ptr<Route>& a, const std::unique_ptr<Route>& b) {
+            return a->prefix.length() > b->prefix.length();
+        });
+    }
+
+    /**
+     * Route for a path, or nullptr if no prefix matches
+     * A prefix matches when the path equals it or continues with '/' after it (a prefix ending
+     * in '/' matches everything below it).
+     */
+    Public Route* FindRoute(CStdString& path) const {
+        for (const auto& route : routes_) {
+            CStdString& prefix = route->prefix;
+            if (path.compare(0, prefix.length(), prefix) != 0) continue;
+            if (path.length() == prefix.length() || prefix.empty() || prefix.back() == '/' || path[prefix.length()] == '/') {
+                return route.get();
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * All routes with their latency histograms and counters
+     */
+    Public const StdVector<std::unique_ptr<Route>>& GetRoutes() const {
+        return routes_;
+    }
+
+    /**
+     * Forward a complete request and return the upstream's response
+     * @return The response, or 502 if no route matches or the upstream failed
+     */
+    Public IHttpResponsePtr Forward(const IHttpRequestPtr& request) {
+        Route* route = FindRoute(request->GetPath());
+        if (route == nullptr) return BadGateway(*request);
+        route->requests.fetch_add(1, std::memory_order_relaxed);
+
+        HttpClientRequest upstreamRequest(MethodToString(request->GetMethod()), request->GetFullUrl(), request->GetBody());
+        upstreamRequest.headers = ProxyHeaders::ForRequest(*request, UpstreamHostHeader(*route));
+
+        const auto start = std::chrono::steady_clock::now();
+        IHttpResponsePtr response = client_.Send(route->host, route->port, upstreamRequest);
+        if (response == nullptr) {
+            route->failures.fetch_add(1, std::memory_order_relaxed);
+            return BadGateway(*request);
+        }
+        route->latency.Record(MicrosSince(start));
+
+        auto simple = std::dynamic_pointer_cast<SimpleHttpResponse>(response);
+        if (simple != nullptr) {
+            const StdString connection = ProxyHeaders::ToLower(response->GetHeader("Connection"));
+            StdVector<StdString> drop;
+            for (const auto& header : response->GetHeaders()) {
+                if (ProxyHeaders::IsHopByHop(ProxyHeaders::ToLower(header.first), connection)) drop.push_back(header.first);
+            }
+            for (CStdString& name : drop) simple->RemoveHeader(name);
+        }
+        response->SetRequestId(request->GetRequestId());
+        return response;
+    }
+
+    /**
+     * Middleware stage: proxy requests that match a route, pass the rest down the chain
+     */
+    template<typename Next>
+    IHttpResponsePtr Handle(const IHttpRequestPtr& request, Next&& next) {
+        if (FindRoute(request->GetPath()) == nullptr) return next(request);
+        return Forward(request);
+    }
+
+    /**
+     * Forward a request whose body is still in the client socket, streaming both bodies
+     * The request body must be framed by Content-Length (chunked request bodies: use Forward()).
+     * A client that sent Expect: 100-continue gets the 100 from the proxy before its body is read.
+     * Interim 1xx responses from the upstream are relayed and the next head is read as the final one.
+     * An upstream head with unusable framing (bad or conflicting Content-Length) or a 101 yields Failed.
+     * @param clientFd Client connection
+     * @param request Parsed request head; its body, if any, is ignored
+     * @param bodyPrefix Body bytes already read from clientFd together with the head
+     * @param bodyLength Total request body length (Content-Length)
+     */
+    Public ProxyStreamStatus Stream(int clientFd, const IHttpRequest& request, CStdString& bodyPrefix, ULong bodyLength) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        Route* route = FindRoute(request.GetPath());
+        if (route == nullptr || bodyPrefix.length() > bodyLength) return ProxyStreamStatus::Failed;
+        route->requests.fetch_add(1, std::memory_order_relaxed);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs_);
+        UpstreamPoolPtr pool = client_.GetPool(route->host, route->port);
+        const StdString head = SerializeHead(request, *route, bodyLength);
+        const Bool headRequest = request.IsMethod(HttpMethod::HEAD);
+
+        const Bool expectsContinue = ProxyHeaders::ToLower(request.GetHeader("Expect")) == "100-continue";
+
+        Bool reused = false;
+        int upstreamFd = -1;
+        StdString responseHead;
+        Size headEnd = StdString::npos;
+        Bool interimSent = false;
+        const auto start = std::chrono::steady_clock::now();
+        // A pooled connection may have been closed by the upstream; without a body to replay, retry once
+        for (int attempt = 0; attempt < 2 && headEnd == StdString::npos; ++attempt) {
+            upstreamFd = pool->Acquire(ProxySplice::RemainingMs(deadline), reused);
+            if (upstreamFd < 0) break;
+            Bool ok = ProxySplice::WriteAll(upstreamFd, head.data(), head.length(), deadline) &&
+                      ProxySplice::WriteAll(upstreamFd, bodyPrefix.data(), bodyPrefix.length(), deadline);
+            const ULong rest = bodyLength - bodyPrefix.length();
+            if (ok && rest > 0 && bodyPrefix.empty() && expectsContinue) {
+                static const char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+                ok = ProxySplice::WriteAll(clientFd, kContinue, sizeof(kContinue) - 1, deadline);
+                interimSent = interimSent || ok;
+            }
+            if (ok && rest > 0) ok = ProxySplice::Transfer(clientFd, upstreamFd, rest, deadline) == static_cast<long long>(rest);
+            char buffer[16 * 1024];
+            while (ok && headEnd == StdString::npos) {
+                const ssize_t count = ::recv(upstreamFd, buffer, sizeof(buffer), MSG_DONTWAIT);
+                if (count > 0) {
+                    responseHead.append(buffer, static_cast<Size>(count));
+                    headEnd = responseHead.find("\r\n\r\n");
+                    // Relay interim heads (e.g. 103 Early Hints); the final response follows on the same connection
+                    while (ok && headEnd != StdString::npos && IsInterimHead(responseHead)) {
+                        Bool interimChunked = false;
+                        ULong interimLength = 0;
+                        Bool interimKeepAlive = false;
+                        UInt interimStatus = 0;
+                        const StdString interim = RewriteResponseHead(responseHead.substr(0, headEnd + 4), interimChunked, interimLength, interimKeepAlive, interimStatus);
+                        if (interim.empty()) {
+                            ok = false;
+                            headEnd = StdString::npos;
+                            break;
+                        }
+                        ok = ProxySplice::WriteAll(clientFd, interim.data(), interim.length(), deadline);
+                        interimSent = true;
+                        responseHead.erase(0, headEnd + 4);
+                        headEnd = responseHead.find("\r\n\r\n");
+                    }
+                    if (headEnd == StdString::npos && responseHead.length() > HttpResponseParser::kMaxHeadBytes) ok = false;
+                } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                    ok = ProxySplice::WaitFor(upstreamFd, POLLIN, deadline);
+                } else {
+                    ok = false;
+                }
+            }
+            if (headEnd != StdString::npos) break;
+            pool->Release(upstreamFd, false);
+            upstreamFd = -1;
+            if (!reused || !responseHead.empty() || interimSent || bodyLength > 0) break;
+        }
+        if (headEnd == StdString::npos) {
+            route->failures.fetch_add(1, std::memory_order_relaxed);
+            return ProxyStreamStatus::Failed;
+        }
+        route->latency.Record(MicrosSince(start));
+
+        Bool chunked = false;
+        ULong contentLength = 0;
+        Bool upstreamKeepAlive = false;
+        UInt statusCode = 0;
+        const StdString clientHead = RewriteResponseHead(responseHead.substr(0, headEnd + 4), chunked, contentLength, upstreamKeepAlive, statusCode);
+        StdString bodyStart = responseHead.substr(headEnd + 4);
+        // Unusable framing, or 101: Upgrade is never forwarded, and the upgraded connection can be
+        // neither relayed as HTTP nor returned to the pool
+        if (clientHead.empty() || statusCode == 101) {
+            pool->Release(upstreamFd, false);
+            route->failures.fetch_add(1, std::memory_order_relaxed);
+            return ProxyStreamStatus::Failed;
+        }
+
+        Bool ok = ProxySplice::WriteAll(clientFd, clientHead.data(), clientHead.length(), deadline);
+        Bool closeDelimited = false;
+        const Bool noBody = headRequest || (statusCode >= 100 && statusCode < 200) || statusCode == 204 || statusCode == 304;
+        if (ok && !noBody) {
+            if (chunked) {
+                Bool clean = true;
+                ok = RelayChunked(upstreamFd, clientFd, std::move(bodyStart), deadline, clean);
+                upstreamKeepAlive = upstreamKeepAlive && clean;
+            } else if (contentLength != static_cast<ULong>(-1)) {
+                const Size prefix = static_cast<Size>(std::min<ULong>(contentLength, bodyStart.length()));
+                ok = ProxySplice::WriteAll(clientFd, bodyStart.data(), prefix, deadline) && bodyStart.length() <= contentLength;
+                const ULong rest = contentLength - prefix;
+                if (ok && rest > 0) ok = ProxySplice::Transfer(upstreamFd, clientFd, rest, deadline) == static_cast<long long>(rest);
+            } else {
+                // Body ends when the upstream closes: relay everything, then close both sides
+                closeDelimited = true;
+                ok = ProxySplice::WriteAll(clientFd, bodyStart.data(), bodyStart.length(), deadline) &&
+                     ProxySplice::Transfer(upstreamFd, clientFd, static_cast<ULong>(-1), deadline) >= 0;
+            }
+        } else if (ok && !bodyStart.empty()) {
+            // Bytes after a body-less response: the upstream stream is out of sync
+            upstreamKeepAlive = false;
+        }
+        pool->Release(upstreamFd, ok && upstreamKeepAlive && !closeDelimited);
+        if (!ok) route->failures.fetch_add(1, std::memory_order_relaxed);
+
+        const StdString clientConnection = ProxyHeaders::ToLower(request.GetHeader("Connection"));
+        const Bool clientKeepAlive = clientConnection.find("close") == StdString::npos &&
+            (request.GetHttpVersion() != "HTTP/1.0" || clientConnection.find("keep-alive") != StdString::npos);
+        return ok && !closeDelimited && clientKeepAlive ? ProxyStreamStatus::KeepAlive : ProxyStreamStatus::Close;
+#else
+        (void)clientFd; (void)request; (void)bodyPrefix; (void)bodyLength;
+        return ProxyStreamStatus::Failed;
+#endif
+    }
+};
+
+#endif // REVERSEPROXY_H
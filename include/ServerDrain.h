@@ -0,0 +1,208 @@
+#ifndef SERVERDRAIN_H
+#define SERVERDRAIN_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+
+/**
+ * Snapshot of a graceful stop in progress
+ */
+class DrainProgress {
+
+    /**
+     * True once the server stopped accepting connections for a graceful stop
+     */
+    Public Bool draining = false;
+
+    /**
+     * Requests received but not yet answered
+     */
+    Public ULong inFlight = 0;
+
+    /**
+     * Requests answered since the drain started
+     */
+    Public ULong completedDuringDrain = 0;
+
+    /**
+     * Requests still in flight when the deadline expired (their connections were closed)
+     */
+    Public ULong abandoned = 0;
+
+    /**
+     * Keep-alive connections closed after a response carrying "Connection: close"
+     */
+    Public ULong connectionsClosed = 0;
+};
+
+/**
+ * Bookkeeping for graceful server shutdown
+ * A server implementation calls BeginRequest()/EndRequest() around every request it hands out via
+ * ReceiveMessage(), passes outgoing responses through PrepareResponse(), and implements
+ * IServer::StopAsync() with Drain(). During a drain:
+ *   - the listener is closed first, so no new connections are accepted;
+ *   - every response gets "Connection: close", so each keep-alive connection is closed after
+ *     its next response instead of mid-response;
+ *   - queued and in-flight requests are completed until they finish or the deadline expires;
+ *   - only then are the remaining connections closed.
+ */
+class ServerDrain {
+
+    Private std::atomic<Bool> draining_;
+    Private std::atomic<ULong> inFlight_;
+    Private std::atomic<ULong> completedDuringDrain_;
+    Private std::atomic<ULong> abandoned_;
+    Private std::atomic<ULong> connectionsClosed_;
+    Private mutable std::mutex mutex_;
+    Private std::condition_variable idle_;
+
+    Public ServerDrain()
+        : draining_(false), inFlight_(0), completedDuringDrain_(0), abandoned_(0), connectionsClosed_(0) {
+    }
+
+    /**
+     * Record that a request was received and will be answered
+     */
+    Public Void BeginRequest() {
+        inFlight_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Record that a request was answered (or its connection dropped)
+     */
+    Public Void EndRequest() {
+        if (draining_.load(std::memory_order_acquire)) {
+            completedDuringDrain_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (inFlight_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.notify_all();
+        }
+    }
+
+    /**
+     * Check whether new connections must be refused
+     */
+    Public Bool IsDraining() const {
+        return draining_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Prepare a serialized response for sending
+     * While draining, sets "Connection: close" so the client does not reuse the connection.
+     * @param rawResponse Serialized HTTP response, modified in place
+     * @return true if the connection must be closed once this response has been written
+     */
+    Public Bool PrepareResponse(StdString& rawResponse) {
+        if (!IsDraining()) {
+            return false;
+        }
+        SetConnectionClose(rawResponse);
+        connectionsClosed_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Set "Connection: close" in the head of a serialized response, replacing any existing Connection header
+     */
+    Public Static Void SetConnectionClose(StdString& rawResponse) {
+        const Size statusLineEnd = rawResponse.find("\r\n");
+        if (statusLineEnd == StdString::npos) {
+            return;
+        }
+        Size headEnd = rawResponse.find("\r\n\r\n");
+        if (headEnd == StdString::npos) {
+            headEnd = rawResponse.length();
+        }
+        Size lineStart = statusLineEnd + 2;
+        while (lineStart < headEnd) {
+            Size lineEnd = rawResponse.find("\r\n", lineStart);
+            if (lineEnd == StdString::npos || lineEnd > headEnd) {
+                lineEnd = headEnd;
+            }
+            static const char name[] = "connection:";
+            Bool matches = lineEnd - lineStart >= sizeof(name) - 1;
+            for (Size i = 0; matches && i < sizeof(name) - 1; ++i) {
+                matches = ::tolower(static_cast<unsigned char>(rawResponse[lineStart + i])) == name[i];
+            }
+            if (matches) {
+                rawResponse.replace(lineStart, lineEnd - lineStart, "Connection: close");
+                return;
+            }
+            lineStart = lineEnd + 2;
+        }
+        rawResponse.insert(statusLineEnd + 2, "Connection: close\r\n");
+    }
+
+    /**
+     * Enter drain mode without waiting (new connections refused, responses close their connection)
+     */
+    Public Void BeginDrain() {
+        draining_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Wait until no request is in flight
+     * @param timeoutMs Maximum time to wait in milliseconds
+     * @return true if all requests completed, false if the timeout expired first
+     */
+    Public Bool WaitForIdle(CUInt timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return idle_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+            return inFlight_.load(std::memory_order_acquire) == 0;
+        });
+    }
+
+    /**
+     * Run a complete graceful stop on a background thread
+     * @param timeoutMs Deadline for in-flight requests in milliseconds
+     * @param stopAccepting Closes the listening socket(s); called first
+     * @param closeAll Closes remaining connections and releases resources; called last
+     * @return Future resolving to true if every in-flight request completed before the deadline
+     */
+    Public std::future<Bool> Drain(CUInt timeoutMs, std::function<Void()> stopAccepting, std::function<Void()> closeAll) {
+        return std::async(std::launch::async, [this, timeoutMs, stopAccepting, closeAll]() -> Bool {
+            if (stopAccepting) {
+                stopAccepting();
+            }
+            BeginDrain();
+            const Bool completed = WaitForIdle(timeoutMs);
+            if (!completed) {
+                abandoned_.store(inFlight_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            }
+            if (closeAll) {
+                closeAll();
+            }
+            return completed;
+        });
+    }
+
+    Public DrainProgress GetProgress() const {
+        DrainProgress progress;
+        progress.draining = IsDraining();
+        progress.inFlight = inFlight_.load(std::memory_order_relaxed);
+        progress.completedDuringDrain = completedDuringDrain_.load(std::memory_order_relaxed);
+        progress.abandoned = abandoned_.load(std::memory_order_relaxed);
+        progress.connectionsClosed = connectionsClosed_.load(std::memory_order_relaxed);
+        return progress;
+    }
+
+    /**
+     * Leave drain mode and clear the counters (e.g. before the server is started again)
+     */
+    Public Void Reset() {
+        draining_.store(false, std::memory_order_release);
+        inFlight_.store(0, std::memory_order_relaxed);
+        completedDuringDrain_.store(0, std::memory_order_relaxed);
+        abandoned_.store(0, std::memory_order_relaxed);
+        connectionsClosed_.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif // SERVERDRAIN_H
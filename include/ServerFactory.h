@@ -5,6 +5,7 @@
 #include <StandardDefines.h>
 #include <functional>
 #include <memory>
+#include <tuple>
 
 /**
  * Factory class for creating server instances
@@ -55,8 +56,11 @@ class ServerFactory {
         }
         
         // Register factory function that creates an instance with arguments
-        serverFactories_[StdString(serverId)] = [args...]() -> IServerPtr {
-            return make_ptr<ServerType>(args...);
+        // Arguments are forwarded into the closure once (moved when passed as rvalues)
+        serverFactories_[StdString(serverId)] = [storedArgs = std::make_tuple(std::forward<Args>(args)...)]() -> IServerPtr {
+            return std::apply([](const auto&... unpackedArgs) {
+                return IServerPtr(make_ptr<ServerType>(unpackedArgs...));
+            }, storedArgs);
         };
         
         return true;
@@ -0,0 +1,123 @@
+#ifndef SIMDSCAN_H
+#define SIMDSCAN_H
+
+#include <StandardDefines.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SERVERLIB_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/**
+ * Byte scanning helpers shared by the JSON and HTTP code
+ * Each helper has an SSE2 path that checks 16 bytes per step and a scalar fallback
+ * used on targets without SSE2 (e.g. ESP32) and for the tail of the input.
+ */
+namespace SimdScan {
+
+    /**
+     * Index of the lowest set bit (mask must be non-zero)
+     */
+    inline UInt LowestBit(UInt mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<UInt>(__builtin_ctz(mask));
+#else
+        UInt index = 0;
+        while ((mask & 1u) == 0) {
+            mask >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    /**
+     * Check whether a byte must be escaped inside a JSON string
+     */
+    inline Bool NeedsJsonEscape(char c) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        return u < 0x20 || c == '"' || c == '\\';
+    }
+
+    /**
+     * Length of the leading run of bytes that can be copied into a JSON string verbatim
+     * @return Offset of the first byte that is '"', '\\' or a control character, or length if none
+     */
+    inline Size FindJsonEscape(const char* data, Size length) {
+        Size i = 0;
+#ifdef SERVERLIB_HAS_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i controlMax = _mm_set1_epi8(0x1F);
+        for (; i + 16 <= length; i += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // chunk <= 0x1F (unsigned) <=> max(chunk, 0x1F) == 0x1F
+            const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, controlMax), controlMax);
+            const __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), control);
+            const UInt mask = static_cast<UInt>(_mm_movemask_epi8(special));
+            if (mask != 0) {
+                return i + LowestBit(mask);
+            }
+        }
+#endif
+        for (; i < length; ++i) {
+            if (NeedsJsonEscape(data[i])) {
+                return i;
+            }
+        }
+        return length;
+    }
+
+    /**
+     * Offset of the first occurrence of a byte, or length if none
+     * Used to find line ends in HTTP heads.
+     */
+    inline Size FindByte(const char* data, Size length, char target) {
+        Size i = 0;
+#ifdef SERVERLIB_HAS_SSE2
+        const __m128i needle = _mm_set1_epi8(target);
+        for (; i + 16 <= length; i += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const UInt mask = static_cast<UInt>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+            if (mask != 0) {
+                return i + LowestBit(mask);
+            }
+        }
+#endif
+        for (; i < length; ++i) {
+            if (data[i] == target) {
+                return i;
+            }
+        }
+        return length;
+    }
+
+    /**
+     * Offset of the first '"' or '\\' in the input, or length if none
+     * Used to skip over the contents of JSON strings.
+     */
+    inline Size FindQuoteOrBackslash(const char* data, Size length) {
+        Size i = 0;
+#ifdef SERVERLIB_HAS_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        for (; i + 16 <= length; i += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const UInt mask = static_cast<UInt>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))));
+            if (mask != 0) {
+                return i + LowestBit(mask);
+            }
+        }
+#endif
+        for (; i < length; ++i) {
+            if (data[i] == '"' || data[i] == '\\') {
+                return i;
+            }
+        }
+        return length;
+    }
+}
+
+#endif // SIMDSCAN_H
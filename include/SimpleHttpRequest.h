@@ -3,9 +3,11 @@
 
 #include <StandardDefines.h>
 #include "HttpMethod.h"
+#include "SimdScan.h"
 #include <sstream>
 #include <algorithm>
 #include <ctime>
+#include <utility>
 
 // Include IHttpRequest - if already included, the guard will prevent re-inclusion
 // but the class will be fully defined
@@ -24,9 +26,13 @@ class SimpleHttpRequest : public IHttpRequest {
     Private StdMap<StdString, StdString> headers_;
     Private StdMap<StdString, StdString> cookies_;
     Private StdString body_;
+    // Copy of body_ (which never changes after construction), built by Parse() so that
+    // GetBodyBytes() stays a plain read for concurrent readers
     Private StdVector<UInt8> bodyBytes_;
+    Private ClientAddress clientAddress_;
+    // Formatted from clientAddress_ by SetClientAddress(), or set verbatim by SetClientIp(), so
+    // that GetClientIp() stays a plain read for concurrent readers
     Private StdString clientIp_;
-    Private UInt clientPort_;
     Private ULong timestamp_;
     Private StdString rawRequest_;
     Private StdString requestId_;
@@ -90,29 +96,37 @@ class SimpleHttpRequest : public IHttpRequest {
     }
 
 
-    Public SimpleHttpRequest(CStdString& requestId, CStdString& rawRequest) 
-        : method_(HttpMethod::GET), clientPort_(0), timestamp_(0) {
-        rawRequest_ = rawRequest;
-        requestId_ = requestId;
+    /**
+     * Parse rawRequest_ into the request fields
+     * Called by the constructors once rawRequest_ and requestId_ are in place
+     */
+    Private Void Parse() {
         timestamp_ = static_cast<ULong>(std::time(nullptr));
         
+        CStdString& rawRequest = rawRequest_;
         if (rawRequest.empty()) return;
         
-        // Find header-body separator
-        Size headerEnd = rawRequest.find("\r\n\r\n");
-        if (headerEnd == StdString::npos) {
-            headerEnd = rawRequest.find("\n\n");
-            if (headerEnd != StdString::npos) headerEnd += 2;
-        } else {
-            headerEnd += 4;
+        // Empty lines before the request line are ignored (RFC 9112 section 2.2)
+        Size headStart = rawRequest.find_first_not_of("\r\n");
+        if (headStart == StdString::npos) headStart = rawRequest.length();
+        
+        // Find header-body separator; the earliest blank line wins, whichever line ending it uses
+        Size headerEnd = StdString::npos;
+        Size headerSectionEnd = rawRequest.length();
+        Size crlfSeparator = rawRequest.find("\r\n\r\n", headStart);
+        Size lfSeparator = rawRequest.find("\n\n", headStart);
+        if (lfSeparator != StdString::npos && (crlfSeparator == StdString::npos || lfSeparator < crlfSeparator)) {
+            headerSectionEnd = lfSeparator;
+            headerEnd = lfSeparator + 2;
+        } else if (crlfSeparator != StdString::npos) {
+            headerSectionEnd = crlfSeparator;
+            headerEnd = crlfSeparator + 4;
         }
         
-        StdString headerSection = (headerEnd != StdString::npos) ? 
-            rawRequest.substr(0, headerEnd - (headerEnd >= 4 ? 4 : 0)) : rawRequest;
+        StdString headerSection = rawRequest.substr(headStart, headerSectionEnd - headStart);
         
         // Parse request line
-        Size firstLineEnd = headerSection.find("\r\n");
-        if (firstLineEnd == StdString::npos) firstLineEnd = headerSection.find('\n');
+        Size firstLineEnd = headerSection.find('\n');
         if (firstLineEnd == StdString::npos) firstLineEnd = headerSection.length();
         
         StdString requestLine = headerSection.substr(0, firstLineEnd);
@@ -134,14 +148,13 @@ class SimpleHttpRequest : public IHttpRequest {
         }
         fullUrl_ = url;
         
-        // Parse headers
-        Size headerStart = firstLineEnd + (headerSection[firstLineEnd] == '\r' ? 2 : 1);
+        // Parse headers (lines end at LF, with an optional preceding CR)
+        Size headerStart = firstLineEnd + 1;
         while (headerStart < headerSection.length()) {
-            Size lineEnd = headerSection.find("\r\n", headerStart);
-            if (lineEnd == StdString::npos) {
-                lineEnd = headerSection.find('\n', headerStart);
-                if (lineEnd == StdString::npos) lineEnd = headerSection.length();
-            }
+            Size lineEnd = headerStart + SimdScan::FindByte(headerSection.data() + headerStart,
+                                                            headerSection.length() - headerStart, '\n');
+            Size nextStart = lineEnd + 1;
+            if (lineEnd > headerStart && headerSection[lineEnd - 1] == '\r') --lineEnd;
             
             if (lineEnd == headerStart) break; // Empty line
             
@@ -165,19 +178,30 @@ class SimpleHttpRequest : public IHttpRequest {
                 }
             }
             
-            headerStart = lineEnd + (headerSection[lineEnd] == '\r' ? 2 : 1);
+            headerStart = nextStart;
         }
         
         // Parse body
         if (headerEnd != StdString::npos && headerEnd < rawRequest.length()) {
             body_ = rawRequest.substr(headerEnd);
-            bodyBytes_.reserve(body_.length());
-            for (Size i = 0; i < body_.length(); ++i) {
-                bodyBytes_.push_back(static_cast<UInt8>(body_[i]));
-            }
+            bodyBytes_.assign(body_.begin(), body_.end());
         }
     }
     
+    Public SimpleHttpRequest(CStdString& requestId, CStdString& rawRequest) 
+        : method_(HttpMethod::GET), timestamp_(0), rawRequest_(rawRequest), requestId_(requestId) {
+        Parse();
+    }
+    
+    /**
+     * Constructor taking ownership of the raw request buffer
+     * Avoids copying the received bytes when the caller no longer needs them
+     */
+    Public SimpleHttpRequest(CStdString& requestId, StdString&& rawRequest) 
+        : method_(HttpMethod::GET), timestamp_(0), rawRequest_(std::move(rawRequest)), requestId_(requestId) {
+        Parse();
+    }
+    
     Public Virtual HttpMethod GetMethod() const override { return method_; }
     Public Virtual CStdString& GetPath() const override { 
         return const_cast<CStdString&>(reinterpret_cast<const CStdString&>(path_)); 
@@ -296,7 +320,11 @@ class SimpleHttpRequest : public IHttpRequest {
     }
     
     Public Virtual UInt GetClientPort() const override {
-        return clientPort_;
+        return clientAddress_.GetPort();
+    }
+    
+    Public Virtual ClientAddress GetClientAddress() const override {
+        return clientAddress_;
     }
     
     Public Virtual StdString GetUserAgent() const override {
@@ -349,8 +377,28 @@ class SimpleHttpRequest : public IHttpRequest {
         return const_cast<CStdString&>(reinterpret_cast<const CStdString&>(requestId_));
     }
     
-    Public Void SetClientIp(CStdString& ip) { clientIp_ = ip; }
-    Public Void SetClientPort(CUInt port) { clientPort_ = port; }
+    /**
+     * Set the client address from its text form; text that is not an IP address is kept verbatim
+     */
+    Public Void SetClientIp(CStdString& ip) {
+        if (!ClientAddress::Parse(ip, clientAddress_.GetPort(), clientAddress_)) {
+            const std::uint16_t port = clientAddress_.GetPort();
+            clientAddress_ = ClientAddress();
+            clientAddress_.SetPort(port);
+        }
+        clientIp_ = ip;
+    }
+    
+    Public Void SetClientPort(CUInt port) { clientAddress_.SetPort(static_cast<std::uint16_t>(port)); }
+    
+    /**
+     * Set the client address in binary form (from accept() or a PROXY preamble)
+     */
+    Public Void SetClientAddress(const ClientAddress& address) {
+        clientAddress_ = address;
+        char buffer[ClientAddress::kMaxStringLength];
+        clientIp_.assign(buffer, clientAddress_.Format(buffer));
+    }
 };
 
 #endif // SIMPLEHTTPREQUEST_H
@@ -6,10 +6,13 @@
 #include <algorithm>
 #include <ctime>
 #include <iomanip>
+#include <charconv>
+#include <utility>
 
 // Include IHttpResponse - if already included, the guard will prevent re-inclusion
 // but the class will be fully defined
 #include "IHttpResponse.h"
+#include "JsonWriter.h"
 
 /**
  * Simple concrete implementation of IHttpResponse interface
@@ -22,6 +25,8 @@ class SimpleHttpResponse : public IHttpResponse {
     Private StdMap<StdString, StdString> headers_;
     Private StdMap<StdString, StdString> setCookies_;
     Private StdString body_;
+    // Copy of body_ (which never changes after construction), built by the constructors so that
+    // GetBodyBytes() stays a plain read for concurrent readers
     Private StdVector<UInt8> bodyBytes_;
     Private ULong timestamp_;
     Private StdString rawResponse_;
@@ -33,7 +38,12 @@ class SimpleHttpResponse : public IHttpResponse {
         return result;
     }
     
-    Private StdString GetStatusMessageForCode(CUInt code) const {
+    /**
+     * Get the standard reason phrase for a status code
+     * @param code HTTP status code
+     * @return Reason phrase (e.g., "OK"), or "Unknown" for unlisted codes
+     */
+    Public Static StdString GetStatusMessageForCode(CUInt code) {
         switch (code) {
             case 200: return "OK";
             case 201: return "Created";
@@ -46,31 +56,58 @@ class SimpleHttpResponse : public IHttpResponse {
             case 403: return "Forbidden";
             case 404: return "Not Found";
             case 405: return "Method Not Allowed";
+            case 413: return "Content Too Large";
+            case 414: return "URI Too Long";
+            case 431: return "Request Header Fields Too Large";
             case 500: return "Internal Server Error";
             case 502: return "Bad Gateway";
             case 503: return "Service Unavailable";
             default: return "Unknown";
         }
     }
-
-    Public SimpleHttpResponse(CStdString& requestId, CStdString& body) 
-        : httpVersion_("HTTP/1.1"), statusCode_(200), statusMessage_("OK"), timestamp_(0) {
-        requestId_ = requestId;
-        body_ = body;
-        timestamp_ = static_cast<ULong>(std::time(nullptr));
-        
-        // Convert body to bytes
+    
+    /**
+     * Set Content-Type/Content-Length for the plain body constructors
+     */
+    Private Void InitPlainBodyHeaders() {
         if (!body_.empty()) {
-            bodyBytes_.reserve(body_.length());
-            for (Size i = 0; i < body_.length(); ++i) {
-                bodyBytes_.push_back(static_cast<UInt8>(body_[i]));
-            }
-            
             // Set default Content-Type if body is not empty
             headers_["Content-Type"] = "text/plain";
             headers_["Content-Length"] = std::to_string(body_.length());
         }
     }
+    
+    /**
+     * Fill in Content-Length/Content-Type for the constructors taking explicit headers
+     */
+    Private Void InitEntityHeaders() {
+        // Ensure Content-Length header is set
+        if (!headers_.count("Content-Length")) {
+            headers_["Content-Length"] = std::to_string(body_.length());
+        }
+        
+        // Set default Content-Type if not provided
+        if (!headers_.count("Content-Type") && !body_.empty()) {
+            headers_["Content-Type"] = "application/json";
+        }
+    }
+
+    Public SimpleHttpResponse(CStdString& requestId, CStdString& body) 
+        : httpVersion_("HTTP/1.1"), statusCode_(200), statusMessage_("OK"), body_(body), 
+          timestamp_(static_cast<ULong>(std::time(nullptr))), requestId_(requestId) {
+        InitPlainBodyHeaders();
+        bodyBytes_.assign(body_.begin(), body_.end());
+    }
+    
+    /**
+     * Constructor taking ownership of the response body
+     */
+    Public SimpleHttpResponse(CStdString& requestId, StdString&& body) 
+        : httpVersion_("HTTP/1.1"), statusCode_(200), statusMessage_("OK"), body_(std::move(body)), 
+          timestamp_(static_cast<ULong>(std::time(nullptr))), requestId_(requestId) {
+        InitPlainBodyHeaders();
+        bodyBytes_.assign(body_.begin(), body_.end());
+    }
 
     /**
      * Constructor with status code, headers, and body
@@ -83,29 +120,62 @@ class SimpleHttpResponse : public IHttpResponse {
         const StdMap<StdString, StdString>& headers,
         CStdString& body
     ) 
-        : httpVersion_("HTTP/1.1"), statusCode_(statusCode), statusMessage_(statusMessage), timestamp_(0) {
-        requestId_ = requestId;
-        body_ = body;
-        headers_ = headers;
-        timestamp_ = static_cast<ULong>(std::time(nullptr));
-        
-        // Convert body to bytes
-        if (!body_.empty()) {
-            bodyBytes_.reserve(body_.length());
-            for (Size i = 0; i < body_.length(); ++i) {
-                bodyBytes_.push_back(static_cast<UInt8>(body_[i]));
-            }
-        }
-        
-        // Ensure Content-Length header is set
-        if (!headers_.count("Content-Length")) {
-            headers_["Content-Length"] = std::to_string(body_.length());
-        }
-        
-        // Set default Content-Type if not provided
-        if (!headers_.count("Content-Type") && !body_.empty()) {
-            headers_["Content-Type"] = "application/json";
-        }
+        : httpVersion_("HTTP/1.1"), statusCode_(statusCode), statusMessage_(statusMessage), headers_(headers), 
+          body_(body), timestamp_(static_cast<ULong>(std::time(nullptr))), requestId_(requestId) {
+        InitEntityHeaders();
+        bodyBytes_.assign(body_.begin(), body_.end());
+    }
+    
+    /**
+     * Constructor for JSON responses serialized with JsonWriter
+     * The writer's buffer becomes the body without copying; Content-Length is its length.
+     */
+    Public SimpleHttpResponse(CStdString& requestId, CUInt statusCode, JsonWriter&& json) 
+        : httpVersion_("HTTP/1.1"), statusCode_(statusCode), statusMessage_(GetStatusMessageForCode(statusCode)), 
+          body_(json.Release()), timestamp_(static_cast<ULong>(std::time(nullptr))), requestId_(requestId) {
+        headers_["Content-Type"] = "application/json";
+        headers_["Content-Length"] = std::to_string(body_.length());
+        bodyBytes_.assign(body_.begin(), body_.end());
+    }
+    
+    /**
+     * Constructor with status code, headers, and body, taking ownership of the headers and body
+     * Used by HttpResponseBuilder and by callers that built the body just for this response
+     */
+    Public SimpleHttpResponse(
+        CStdString& requestId, 
+        CUInt statusCode,
+        StdString&& statusMessage,
+        StdMap<StdString, StdString>&& headers,
+        StdString&& body
+    ) 
+        : httpVersion_("HTTP/1.1"), statusCode_(statusCode), statusMessage_(std::move(statusMessage)), 
+          headers_(std::move(headers)), body_(std::move(body)), 
+          timestamp_(static_cast<ULong>(std::time(nullptr))), requestId_(requestId) {
+        InitEntityHeaders();
+        bodyBytes_.assign(body_.begin(), body_.end());
+    }
+    
+    /**
+     * Constructor for a response received from a peer (see HttpResponseParser)
+     * Headers are kept exactly as received; no Content-Type or Content-Length defaults are added.
+     * @param setCookies Set-Cookie field values keyed by cookie name
+     * @param rawResponse The response bytes as received, returned by GetRawResponse()
+     */
+    Public SimpleHttpResponse(
+        CStdString& requestId,
+        StdString&& httpVersion,
+        CUInt statusCode,
+        StdString&& statusMessage,
+        StdMap<StdString, StdString>&& headers,
+        StdString&& body,
+        StdMap<StdString, StdString>&& setCookies = StdMap<StdString, StdString>(),
+        StdString&& rawResponse = StdString()
+    )
+        : httpVersion_(std::move(httpVersion)), statusCode_(statusCode), statusMessage_(std::move(statusMessage)),
+          headers_(std::move(headers)), setCookies_(std::move(setCookies)), body_(std::move(body)),
+          timestamp_(static_cast<ULong>(std::time(nullptr))), rawResponse_(std::move(rawResponse)), requestId_(requestId) {
+        bodyBytes_.assign(body_.begin(), body_.end());
     }
     
     Public Virtual CStdString& GetHttpVersion() const override { 
@@ -236,37 +306,57 @@ class SimpleHttpResponse : public IHttpResponse {
     }
     
     Public Virtual StdString ToHttpString() const override {
-        std::ostringstream oss;
+        // Size the output once so the body is copied exactly one time
+        Size outputSize = httpVersion_.length() + statusMessage_.length() + 8;
+        for (const auto& pair : headers_) {
+            outputSize += pair.first.length() + pair.second.length() + 4;
+        }
+        for (const auto& pair : setCookies_) {
+            outputSize += pair.second.length() + 14;
+        }
+        outputSize += 40 + body_.length();
+        
+        StdString output;
+        output.reserve(outputSize);
         
         // Status line: HTTP/1.1 200 OK
-        oss << httpVersion_ << " " 
-            << statusCode_ << " " 
-            << statusMessage_ << "\r\n";
+        char number[24];
+        output.append(httpVersion_);
+        output.push_back(' ');
+        output.append(number, static_cast<Size>(std::to_chars(number, number + sizeof(number), statusCode_).ptr - number));
+        output.push_back(' ');
+        output.append(statusMessage_);
+        output.append("\r\n", 2);
         
         // Headers
         for (const auto& pair : headers_) {
-            oss << pair.first << ": " << pair.second << "\r\n";
+            output.append(pair.first);
+            output.append(": ", 2);
+            output.append(pair.second);
+            output.append("\r\n", 2);
         }
         
         // Set-Cookie headers (if any)
         for (const auto& pair : setCookies_) {
-            oss << "Set-Cookie: " << pair.second << "\r\n";
+            output.append("Set-Cookie: ", 12);
+            output.append(pair.second);
+            output.append("\r\n", 2);
         }
         
         // Ensure Content-Length is set if body exists
         if (HasBody() && !HasHeader("Content-Length")) {
-            oss << "Content-Length: " << body_.length() << "\r\n";
+            output.append("Content-Length: ", 16);
+            output.append(number, static_cast<Size>(std::to_chars(number, number + sizeof(number), body_.length()).ptr - number));
+            output.append("\r\n", 2);
         }
         
         // Empty line to separate headers from body
-        oss << "\r\n";
+        output.append("\r\n", 2);
         
         // Body
-        if (HasBody()) {
-            oss << body_;
-        }
+        output.append(body_);
         
-        return oss.str();
+        return output;
     }
     
     Public Virtual Bool HasBody() const override {
@@ -336,6 +426,17 @@ class SimpleHttpResponse : public IHttpResponse {
         headers_[StdString(name)] = StdString(value);
     }
     
+    /**
+     * Remove a header (name matched case-insensitively), e.g. a hop-by-hop header before forwarding
+     */
+    Public Void RemoveHeader(CStdString& name) {
+        const StdString lowerName = ToLower(name);
+        for (auto it = headers_.begin(); it != headers_.end(); ) {
+            if (ToLower(it->first) == lowerName) it = headers_.erase(it);
+            else ++it;
+        }
+    }
+    
     Public Void SetContentType(CStdString& contentType) {
         headers_["Content-Type"] = StdString(contentType);
     }
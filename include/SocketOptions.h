@@ -0,0 +1,261 @@
+#ifndef SOCKETOPTIONS_H
+#define SOCKETOPTIONS_H
+
+#include <StandardDefines.h>
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+/**
+ * Socket configuration applied by a server in Start() and on every accepted connection
+ * Accepted by IServer::SetSocketOptions(). Zero for a size or timeout means "keep the OS default".
+ * The presets follow the intent of each option and are not tuned from measurements; use one as a
+ * starting point and adjust it against your own load:
+ *
+ *   SocketOptions options = SocketOptions::Latency();
+ *   options.backlog = 4096;
+ *   server->SetSocketOptions(options);
+ */
+class SocketOptions {
+
+    /**
+     * listen() backlog (capped by net.core.somaxconn)
+     */
+    Public int backlog = 1024;
+
+    /**
+     * TCP_NODELAY on accepted connections: send small writes immediately instead of waiting for ACKs
+     */
+    Public Bool noDelay = true;
+
+    /**
+     * TCP_DEFER_ACCEPT: only wake accept() once request data has arrived (seconds, 0 = off; Linux)
+     */
+    Public int deferAcceptSeconds = 0;
+
+    /**
+     * TCP_FASTOPEN queue length on the listener: accept data in the SYN from returning clients (0 = off)
+     */
+    Public int fastOpenQueue = 0;
+
+    /**
+     * SO_RCVBUF / SO_SNDBUF in bytes (0 = kernel autotuning, which setting a value disables)
+     */
+    Public int receiveBufferBytes = 0;
+    Public int sendBufferBytes = 0;
+
+    /**
+     * SO_KEEPALIVE with TCP_KEEPIDLE seconds (0 = off), to shed dead idle connections
+     */
+    Public int keepAliveIdleSeconds = 0;
+
+    /**
+     * Coalesce the response head and body into full segments (MSG_MORE / TCP_CORK)
+     */
+    Public Bool corkResponses = false;
+
+    /**
+     * SO_REUSEPORT on the listener, for one listener per reactor shard
+     */
+    Public Bool reusePort = false;
+
+    /**
+     * Small request/response exchanges: no Nagle delay, TCP Fast Open, and accept() woken by the
+     * first request byte rather than the handshake (a connection that sends nothing is still
+     * accepted after about a second)
+     */
+    Public Static SocketOptions Latency() {
+        SocketOptions options;
+        options.noDelay = true;
+        options.deferAcceptSeconds = 1;
+        options.fastOpenQueue = 256;
+        return options;
+    }
+
+    /**
+     * Large responses: full segments and larger buffers
+     */
+    Public Static SocketOptions Throughput() {
+        SocketOptions options;
+        options.noDelay = true;
+        options.corkResponses = true;
+        options.backlog = 4096;
+        options.sendBufferBytes = 4 * 1024 * 1024;
+        return options;
+    }
+
+    /**
+     * Many mostly idle keep-alive connections: small buffers, deferred accept, dead peer detection
+     */
+    Public Static SocketOptions ManyIdleConnections() {
+        SocketOptions options;
+        options.noDelay = true;
+        options.backlog = 65535;
+        options.deferAcceptSeconds = 5;
+        options.receiveBufferBytes = 16 * 1024;
+        options.sendBufferBytes = 16 * 1024;
+        options.keepAliveIdleSeconds = 60;
+        return options;
+    }
+};
+
+/**
+ * Helpers applying SocketOptions to raw sockets (stubs returning false where unsupported)
+ */
+namespace SocketTuning {
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+    inline Bool SetIntOption(int fd, int level, int name, int value) {
+        return ::setsockopt(fd, level, name, &value, sizeof(value)) == 0;
+    }
+#endif
+
+    /**
+     * Options that must be set on the listening socket; call after socket() and before bind()
+     * (SO_REUSEPORT) respectively before listen() (the rest). Pass options.backlog to listen().
+     * @return true if every requested option was accepted
+     */
+    inline Bool ApplyToListener(int fd, const SocketOptions& options) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        Bool applied = true;
+#ifdef SO_REUSEPORT
+        if (options.reusePort) applied = SetIntOption(fd, SOL_SOCKET, SO_REUSEPORT, 1) && applied;
+#endif
+#if defined(SERVERLIB_LINUX) && defined(TCP_DEFER_ACCEPT)
+        if (options.deferAcceptSeconds > 0) {
+            applied = SetIntOption(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, options.deferAcceptSeconds) && applied;
+        }
+#endif
+#ifdef TCP_FASTOPEN
+        if (options.fastOpenQueue > 0) {
+            applied = SetIntOption(fd, IPPROTO_TCP, TCP_FASTOPEN, options.fastOpenQueue) && applied;
+        }
+#endif
+        // Buffer sizes set on the listener are inherited by accepted sockets and affect the window scale
+        if (options.receiveBufferBytes > 0) {
+            applied = SetIntOption(fd, SOL_SOCKET, SO_RCVBUF, options.receiveBufferBytes) && applied;
+        }
+        if (options.sendBufferBytes > 0) {
+            applied = SetIntOption(fd, SOL_SOCKET, SO_SNDBUF, options.sendBufferBytes) && applied;
+        }
+        return applied;
+#else
+        (void)fd;
+        (void)options;
+        return false;
+#endif
+    }
+
+    /**
+     * Per-connection options; call right after accept()
+     * @return true if every requested option was accepted
+     */
+    inline Bool ApplyToConnection(int fd, const SocketOptions& options) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        Bool applied = true;
+        if (options.noDelay) applied = SetIntOption(fd, IPPROTO_TCP, TCP_NODELAY, 1) && applied;
+        if (options.keepAliveIdleSeconds > 0) {
+            applied = SetIntOption(fd, SOL_SOCKET, SO_KEEPALIVE, 1) && applied;
+#ifdef TCP_KEEPIDLE
+            applied = SetIntOption(fd, IPPROTO_TCP, TCP_KEEPIDLE, options.keepAliveIdleSeconds) && applied;
+#endif
+        }
+        return applied;
+#else
+        (void)fd;
+        (void)options;
+        return false;
+#endif
+    }
+
+    /**
+     * Hold back partial segments until Cork(fd, false) (TCP_CORK on Linux, TCP_NOPUSH on BSD/macOS)
+     */
+    inline Bool Cork(int fd, Bool enable) {
+#if defined(SERVERLIB_LINUX) && defined(TCP_CORK)
+        return SetIntOption(fd, IPPROTO_TCP, TCP_CORK, enable ? 1 : 0);
+#elif defined(SERVERLIB_POSIX_SOCKETS) && defined(TCP_NOPUSH)
+        return SetIntOption(fd, IPPROTO_TCP, TCP_NOPUSH, enable ? 1 : 0);
+#else
+        (void)fd;
+        (void)enable;
+        return false;
+#endif
+    }
+
+    /**
+     * Write a response head and body without a small head-only segment on the wire
+     * With corkResponses the head is sent with MSG_MORE so the kernel merges it with the body;
+     * otherwise both parts go out in one sendmsg(). Blocking sockets only.
+     * @return true if both parts were written completely
+     */
+    inline Bool SendHeadAndBody(int fd, CStdString& head, CStdString& body, const SocketOptions& options) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (head.empty() && body.empty()) return true;
+        int noSignal = 0;
+#ifdef MSG_NOSIGNAL
+        noSignal = MSG_NOSIGNAL;
+#endif
+#if defined(SERVERLIB_LINUX) && defined(MSG_MORE)
+        if (options.corkResponses && !body.empty()) {
+            Size offset = 0;
+            while (offset < head.size()) {
+                const ssize_t sent = ::send(fd, head.data() + offset, head.size() - offset, MSG_MORE | noSignal);
+                if (sent < 0 && errno == EINTR) continue;
+                if (sent <= 0) return false;
+                offset += static_cast<Size>(sent);
+            }
+            offset = 0;
+            while (offset < body.size()) {
+                const ssize_t sent = ::send(fd, body.data() + offset, body.size() - offset, noSignal);
+                if (sent < 0 && errno == EINTR) continue;
+                if (sent <= 0) return false;
+                offset += static_cast<Size>(sent);
+            }
+            return true;
+        }
+#else
+        (void)options;
+#endif
+        iovec parts[2] = {
+            { const_cast<char*>(head.data()), head.size() },
+            { const_cast<char*>(body.data()), body.size() }
+        };
+        iovec* remaining = parts;
+        int count = 2;
+        while (count > 0) {
+            msghdr message{};
+            message.msg_iov = remaining;
+            message.msg_iovlen = count;
+            const ssize_t sent = ::sendmsg(fd, &message, noSignal);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+            // Advance past what the kernel took, possibly ending inside the head
+            Size advance = static_cast<Size>(sent);
+            while (count > 0 && advance >= remaining->iov_len) {
+                advance -= remaining->iov_len;
+                ++remaining;
+                --count;
+            }
+            if (count > 0) {
+                remaining->iov_base = static_cast<char*>(remaining->iov_base) + advance;
+                remaining->iov_len -= advance;
+            }
+        }
+        return true;
+#else
+        (void)fd;
+        (void)head;
+        (void)body;
+        (void)options;
+        return false;
+#endif
+    }
+}
+
+#endif // SOCKETOPTIONS_H
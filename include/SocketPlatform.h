@@ -0,0 +1,18 @@
+#ifndef SOCKETPLATFORM_H
+#define SOCKETPLATFORM_H
+
+/**
+ * Platform detection for the socket-level helpers
+ * SERVERLIB_POSIX_SOCKETS: BSD sockets, Unix domain sockets, fork() (Linux, macOS, BSDs)
+ * SERVERLIB_LINUX: Linux-only socket options and syscalls (epoll, MSG_ZEROCOPY, SO_INCOMING_CPU, ...)
+ * On other targets (e.g. ESP32/Arduino) the helpers compile to stubs that report "not supported".
+ */
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define SERVERLIB_POSIX_SOCKETS 1
+#endif
+
+#if defined(__linux__) && defined(SERVERLIB_POSIX_SOCKETS)
+#define SERVERLIB_LINUX 1
+#endif
+
+#endif // SOCKETPLATFORM_H
@@ -0,0 +1,295 @@
+#ifndef TOKENCACHE_H
+#define TOKENCACHE_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "Base64.h"
+#include "FastHash.h"
+#include "HttpResponseBuilder.h"
+#include "IHttpRequest.h"
+#include "JsonView.h"
+
+/**
+ * Sharded, bounded cache of verified bearer tokens
+ * Signature verification (HMAC/ECDSA) runs once per token; later requests with the same token hit
+ * the cache until the token's exp claim passes or it is evicted (least recently used per shard).
+ * Keyed by FastHash of the token with the full token compared on lookup, so a hash collision can
+ * never authorize a different token.
+ */
+class TokenCache {
+
+    Public Static constexpr UInt kShardCount = 16;
+
+    Private class Entry {
+        Public StdString token;
+        Public StdString claims;
+        Public long long expiresAt;
+    };
+
+    Private class alignas(64) Shard {
+        Public std::mutex mutex;
+        // Most recently used first
+        Public std::list<Entry> entries;
+        Public std::unordered_multimap<std::uint64_t, std::list<Entry>::iterator> index;
+    };
+
+    Private Shard shards_[kShardCount];
+    Private Size capacityPerShard_;
+    Private std::atomic<ULong> hits_;
+    Private std::atomic<ULong> misses_;
+    Private std::atomic<ULong> expired_;
+    Private std::atomic<ULong> evictions_;
+
+    Private Static long long NowSeconds() {
+        return static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    Private Shard& ShardFor(std::uint64_t hash) {
+        return shards_[(hash >> 59) % kShardCount];
+    }
+
+    Private Static std::unordered_multimap<std::uint64_t, std::list<Entry>::iterator>::iterator
+    FindInShard(Shard& shard, std::uint64_t hash, std::string_view token) {
+        auto range = shard.index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->token == token) return it;
+        }
+        return shard.index.end();
+    }
+
+    /**
+     * @param capacity Maximum number of cached tokens across all shards
+     */
+    Public explicit TokenCache(Size capacity = 16384)
+        : capacityPerShard_(capacity / kShardCount > 0 ? capacity / kShardCount : 1),
+          hits_(0), misses_(0), expired_(0), evictions_(0) {
+    }
+
+    TokenCache(const TokenCache&) = delete;
+    TokenCache& operator=(const TokenCache&) = delete;
+
+    /**
+     * Look up a verified token
+     * @param token Bearer token as sent by the client
+     * @param claims Receives the cached claims (the JWT payload JSON) on a hit; may be nullptr
+     * @param now Current Unix time in seconds; 0 reads the clock
+     * @return true if the token was verified earlier and has not expired
+     */
+    Public Bool Lookup(std::string_view token, StdString* claims = nullptr, long long now = 0) {
+        const std::uint64_t hash = FastHash::Hash64(token);
+        Shard& shard = ShardFor(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = FindInShard(shard, hash, token);
+        if (found == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto entry = found->second;
+        if (entry->expiresAt > 0 && entry->expiresAt <= (now != 0 ? now : NowSeconds())) {
+            shard.entries.erase(entry);
+            shard.index.erase(found);
+            expired_.fetch_add(1, std::memory_order_relaxed);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+        if (claims != nullptr) *claims = entry->claims;
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Remember a token whose signature has been verified
+     * @param expiresAt Unix time (seconds) after which the token is no longer accepted; 0 = no expiry
+     */
+    Public Void Insert(std::string_view token, StdString claims, long long expiresAt) {
+        const std::uint64_t hash = FastHash::Hash64(token);
+        Shard& shard = ShardFor(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = FindInShard(shard, hash, token);
+        if (found != shard.index.end()) {
+            found->second->claims = std::move(claims);
+            found->second->expiresAt = expiresAt;
+            shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+            return;
+        }
+        if (shard.entries.size() >= capacityPerShard_) {
+            const std::uint64_t victimHash = FastHash::Hash64(shard.entries.back().token);
+            auto victim = FindInShard(shard, victimHash, shard.entries.back().token);
+            if (victim != shard.index.end()) shard.index.erase(victim);
+            shard.entries.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.entries.push_front(Entry{ StdString(token), std::move(claims), expiresAt });
+        shard.index.emplace(hash, shard.entries.begin());
+    }
+
+    /**
+     * Drop a token, e.g. after it was revoked
+     */
+    Public Void Remove(std::string_view token) {
+        const std::uint64_t hash = FastHash::Hash64(token);
+        Shard& shard = ShardFor(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = FindInShard(shard, hash, token);
+        if (found == shard.index.end()) return;
+        shard.entries.erase(found->second);
+        shard.index.erase(found);
+    }
+
+    Public Void Clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+            shard.index.clear();
+        }
+    }
+
+    Public Size GetSize() {
+        Size total = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+
+    Public ULong GetHitCount() const { return hits_.load(std::memory_order_relaxed); }
+    Public ULong GetMissCount() const { return misses_.load(std::memory_order_relaxed); }
+    Public ULong GetExpiredCount() const { return expired_.load(std::memory_order_relaxed); }
+    Public ULong GetEvictionCount() const { return evictions_.load(std::memory_order_relaxed); }
+
+    /**
+     * Fraction of lookups served from the cache (0 when there were none)
+     */
+    Public double GetHitRate() const {
+        const ULong hits = GetHitCount();
+        const ULong total = hits + GetMissCount();
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+
+    /**
+     * Decoded payload (claims JSON) of a JWT "header.payload.signature", without verifying it
+     * @return false if the token is not a well-formed JWT
+     */
+    Public Static Bool GetJwtPayload(std::string_view token, StdString& payload) {
+        const Size first = token.find('.');
+        if (first == std::string_view::npos) return false;
+        const Size second = token.find('.', first + 1);
+        if (second == std::string_view::npos) return false;
+        return Base64::DecodeUrl(token.substr(first + 1, second - first - 1), payload);
+    }
+
+    /**
+     * exp claim of a decoded JWT payload
+     * Uses its own parser: re-indexing JsonParser::ThreadLocal() here would invalidate the views a
+     * handler on this thread holds from IHttpRequest::GetJson().
+     * @return Unix time in seconds, 0 if the payload has no numeric exp
+     */
+    Public Static long long GetExpiry(std::string_view payload) {
+        JsonParser parser;
+        JsonValue exp = parser.Index(payload)["exp"];
+        return exp.IsNumber() ? exp.GetInt64() : 0;
+    }
+};
+
+/**
+ * Middleware stage authenticating requests by bearer token through a TokenCache
+ * Cache misses go to the verifier (signature check); verified tokens are cached until their exp.
+ * Requests without a valid token get 401 with WWW-Authenticate: Bearer. While the rest of the
+ * pipeline runs, GetClaims() returns the token's claims, whether they came from the cache or from
+ * the token just verified.
+ *
+ *   BearerAuthStage auth(cache, [](std::string_view token) { return VerifyHs256(token, secret); });
+ *   MiddlewarePipeline<BearerAuthStage, ...> pipeline(auth, ...);
+ *
+ *   // in the handler
+ *   JsonParser parser;
+ *   StdString subject = parser.Index(BearerAuthStage::GetClaims())["sub"].GetString();
+ */
+class BearerAuthStage {
+
+    Private TokenCache* cache_;
+    Private std::function<Bool(std::string_view)> verifier_;
+
+    Private Static const StdString*& CurrentClaims() {
+        static thread_local const StdString* claims = nullptr;
+        return claims;
+    }
+
+    /**
+     * Publishes claims to GetClaims() for the duration of next(); restores the outer value (nesting)
+     */
+    Private class ClaimsScope {
+        Private const StdString* previous_;
+
+        Public explicit ClaimsScope(const StdString& claims) : previous_(CurrentClaims()) {
+            CurrentClaims() = &claims;
+        }
+
+        Public ~ClaimsScope() {
+            CurrentClaims() = previous_;
+        }
+
+        ClaimsScope(const ClaimsScope&) = delete;
+        ClaimsScope& operator=(const ClaimsScope&) = delete;
+    };
+
+    Private Static IHttpResponsePtr Unauthorized(const IHttpRequestPtr& request) {
+        return HttpResponseBuilder(request->GetRequestId())
+            .Status(401)
+            .Header("WWW-Authenticate", "Bearer")
+            .Build();
+    }
+
+    /**
+     * @param cache Cache shared by all requests (and threads)
+     * @param verifier Returns true if the token's signature is valid
+     */
+    Public BearerAuthStage(TokenCache& cache, std::function<Bool(std::string_view)> verifier)
+        : cache_(&cache), verifier_(std::move(verifier)) {}
+
+    /**
+     * Claims (JWT payload JSON) of the token that authenticated the request this thread is handling
+     * @return Empty outside the stages and handler that run after this stage
+     */
+    Public Static CStdString& GetClaims() {
+        static const StdString empty;
+        const StdString* claims = CurrentClaims();
+        return claims != nullptr ? *claims : empty;
+    }
+
+    template<typename Next>
+    IHttpResponsePtr Handle(const IHttpRequestPtr& request, Next&& next) {
+        const StdString token = request->GetBearerToken();
+        if (token.empty()) return Unauthorized(request);
+        StdString claims;
+        if (cache_->Lookup(token, &claims)) {
+            ClaimsScope scope(claims);
+            return next(request);
+        }
+
+        StdString payload;
+        if (!TokenCache::GetJwtPayload(token, payload) || !verifier_ || !verifier_(token)) {
+            return Unauthorized(request);
+        }
+        const long long expiresAt = TokenCache::GetExpiry(payload);
+        const long long now = static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        if (expiresAt != 0 && expiresAt <= now) return Unauthorized(request);
+        cache_->Insert(token, payload, expiresAt);
+        ClaimsScope scope(payload);
+        return next(request);
+    }
+};
+
+#endif // TOKENCACHE_H
@@ -0,0 +1,468 @@
+#ifndef TRAFFICCAPTURE_H
+#define TRAFFICCAPTURE_H
+
+#include <StandardDefines.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * On-disk layout of a traffic capture log (little-endian, all blocks 8-byte aligned)
+ *
+ *   FileHeader | Chunk | Chunk | ... | Index | Chunk | ... | Index
+ *
+ * A Chunk is one flushed staging buffer: ChunkHeader followed by recordCount records, each a
+ * RecordHeader and the raw request bytes padded to 8. Chunks from different threads interleave,
+ * so timestamps increase within a chunk but not across the file. Every indexEveryChunks chunks an
+ * Index block (ChunkHeader with kIndexMagic, the previous index offset, then one IndexEntry per
+ * chunk) is appended; FileHeader::lastIndexOffset points to the newest one after Close().
+ */
+namespace TrafficLog {
+
+    static constexpr char kFileMagic[8] = { 'S', 'L', 'T', 'R', 'A', 'F', 'F', '1' };
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kChunkMagic = 0x4B4E4843;    // "CHNK"
+    static constexpr std::uint32_t kIndexMagic = 0x58444E49;    // "INDX"
+
+    class FileHeader {
+        Public char magic[8];
+        Public std::uint32_t version;
+        Public std::uint32_t headerSize;
+        // Wall-clock time of the capture start (ns since the Unix epoch); record timestamps are relative to it
+        Public std::uint64_t startWallNs;
+        // End of the last complete block; set by Close()
+        Public std::uint64_t dataEnd;
+        Public std::uint64_t lastIndexOffset;
+        Public std::uint64_t recordCount;
+        Public std::uint8_t reserved[16];
+    };
+
+    class ChunkHeader {
+        Public std::uint32_t magic;
+        Public std::uint32_t recordCount;
+        // Including this header
+        Public std::uint64_t length;
+        Public std::uint64_t firstNs;
+        Public std::uint64_t lastNs;
+    };
+
+    class RecordHeader {
+        Public std::uint32_t length;
+        Public std::uint32_t flags;
+        // Arrival time in ns since the capture start (monotonic clock)
+        Public std::uint64_t timestampNs;
+    };
+
+    class IndexEntry {
+        Public std::uint64_t offset;
+        Public std::uint64_t firstNs;
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "capture file header layout");
+    static_assert(sizeof(ChunkHeader) == 32, "capture chunk header layout");
+    static_assert(sizeof(RecordHeader) == 16, "capture record header layout");
+    static_assert(sizeof(IndexEntry) == 16, "capture index entry layout");
+
+    inline Size Align8(Size value) {
+        return (value + 7) & ~static_cast<Size>(7);
+    }
+}
+
+/**
+ * Settings for TrafficCapture::Open()
+ */
+class TrafficCaptureConfig {
+
+    /**
+     * Fraction of requests recorded (0-1); sampling is decided per request
+     */
+    Public double sampleRate = 1.0;
+
+    /**
+     * Size the log may grow to; records that do not fit are dropped and counted
+     */
+    Public std::uint64_t maxFileBytes = 1ULL << 30;
+
+    /**
+     * Per-thread staging buffer; records reach the log one full buffer at a time
+     */
+    Public Size stagingBytes = 64 * 1024;
+
+    /**
+     * Staging buffers older than this are written on the next record (0 = only when full or on Flush())
+     */
+    Public UInt flushIntervalMs = 1000;
+
+    /**
+     * Chunks between index blocks
+     */
+    Public UInt indexEveryChunks = 64;
+};
+
+/**
+ * Capture of raw request bytes with arrival timestamps into a memory-mapped append-only log
+ * Each thread appends to its own staging buffer (no shared lock, no syscall per request); full
+ * buffers are copied into the mapping at an offset reserved with one atomic add. The file is sized
+ * to maxFileBytes up front (sparse) and truncated to the data written by Close(). Replay the log
+ * with TrafficReplay.
+ *
+ *   TrafficCapture capture;
+ *   capture.Open("/var/tmp/traffic.slcap", config);
+ *   server->SetTrafficCapture(&capture);   // or capture.Record(rawBytes, length) from the read path
+ *   ...
+ *   server->SetTrafficCapture(nullptr);
+ *   capture.Close();
+ */
+class TrafficCapture {
+
+    /**
+     * One thread's pending chunk
+     */
+    Private class Staging {
+        Public std::unique_ptr<char[]> data;
+        Public Size capacity = 0;
+        // Bytes used, starting after the space reserved for the ChunkHeader
+        Public Size used = sizeof(TrafficLog::ChunkHeader);
+        Public std::uint32_t count = 0;
+        Public std::uint64_t firstNs = 0;
+        Public std::uint64_t lastNs = 0;
+        Public std::uint64_t startedNs = 0;
+        // Held by the owning thread while appending, and by Flush()/Close() from other threads
+        Public std::atomic<Bool> busy{ false };
+    };
+
+    Private Static std::atomic<std::uint64_t>& InstanceCounter() {
+        static std::atomic<std::uint64_t> counter{ 0 };
+        return counter;
+    }
+
+    Private const std::uint64_t id_;
+    Private TrafficCaptureConfig config_;
+    Private std::atomic<Bool> open_;
+    Private int fd_;
+    Private char* map_;
+    Private std::uint64_t mapSize_;
+    Private std::atomic<std::uint64_t> writeOffset_;
+    // End of the furthest block actually written (a failed reservation leaves no hole before it)
+    Private std::atomic<std::uint64_t> committedEnd_;
+    Private std::uint64_t startNs_;
+    Private std::uint32_t sampleThreshold_;
+    Private std::mutex registryMutex_;
+    Private StdVector<std::unique_ptr<Staging>> stagings_;
+    Private std::mutex indexMutex_;
+    Private StdVector<TrafficLog::IndexEntry> pendingIndex_;
+    Private std::uint64_t lastIndexOffset_;
+    Private std::atomic<ULong> recorded_;
+    Private std::atomic<ULong> sampledOut_;
+    Private std::atomic<ULong> dropped_;
+
+    Private Static std::uint64_t MonotonicNs() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    Private Static Void Acquire(std::atomic<Bool>& flag) {
+        Bool expected = false;
+        while (!flag.compare_exchange_weak(expected, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+            expected = false;
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Per-thread sampling decision (xorshift; no shared state)
+     */
+    Private Bool Sampled() const {
+        if (sampleThreshold_ == UINT32_MAX) return true;
+        thread_local std::uint64_t state = 0x9E3779B97F4A7C15ULL ^
+            static_cast<std::uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<std::uint32_t>(state >> 32) < sampleThreshold_;
+    }
+
+    /**
+     * This thread's staging buffer for this capture, created on first use
+     */
+    Private Staging& LocalStaging() {
+        class CacheEntry {
+            Public std::uint64_t owner = UINT64_MAX;
+            Public Staging* staging = nullptr;
+        };
+        thread_local CacheEntry cache[4];
+        thread_local UInt nextSlot = 0;
+        for (CacheEntry& entry : cache) {
+            if (entry.owner == id_) return *entry.staging;
+        }
+        std::unique_ptr<Staging> staging(new Staging());
+        staging->capacity = config_.stagingBytes;
+        staging->data.reset(new char[staging->capacity]);
+        Staging* pointer = staging.get();
+        {
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            stagings_.push_back(std::move(staging));
+        }
+        CacheEntry& slot = cache[nextSlot++ % 4];
+        slot.owner = id_;
+        slot.staging = pointer;
+        return *pointer;
+    }
+
+    /**
+     * Reserve space at the end of the log
+     * @return Offset, or UINT64_MAX if the log is full
+     */
+    Private std::uint64_t Reserve(std::uint64_t length) {
+        const std::uint64_t offset = writeOffset_.fetch_add(length, std::memory_order_relaxed);
+        if (offset + length > mapSize_) return UINT64_MAX;
+        std::uint64_t end = committedEnd_.load(std::memory_order_relaxed);
+        while (offset + length > end && !committedEnd_.compare_exchange_weak(end, offset + length, std::memory_order_relaxed)) {
+        }
+        return offset;
+    }
+
+    /**
+     * Append an index block for the chunks written since the previous one (indexMutex_ held)
+     */
+    Private Void WriteIndexLocked() {
+        if (pendingIndex_.empty()) return;
+        const std::uint64_t length = sizeof(TrafficLog::ChunkHeader) + sizeof(std::uint64_t) +
+                                     pendingIndex_.size() * sizeof(TrafficLog::IndexEntry);
+        const std::uint64_t offset = Reserve(length);
+        if (offset == UINT64_MAX) return;
+        TrafficLog::ChunkHeader header{ TrafficLog::kIndexMagic, static_cast<std::uint32_t>(pendingIndex_.size()), length,
+                                        pendingIndex_.front().firstNs, pendingIndex_.back().firstNs };
+        char* out = map_ + offset;
+        std::memcpy(out, &header, sizeof(header));
+        std::memcpy(out + sizeof(header), &lastIndexOffset_, sizeof(lastIndexOffset_));
+        std::memcpy(out + sizeof(header) + sizeof(lastIndexOffset_), pendingIndex_.data(),
+                    pendingIndex_.size() * sizeof(TrafficLog::IndexEntry));
+        lastIndexOffset_ = offset;
+        pendingIndex_.clear();
+    }
+
+    /**
+     * Copy a staging buffer into the log as one chunk (staging.busy held)
+     */
+    Private Void FlushStaging(Staging& staging) {
+        if (staging.count == 0) return;
+        const std::uint64_t offset = Reserve(staging.used);
+        if (offset == UINT64_MAX) {
+            dropped_.fetch_add(staging.count, std::memory_order_relaxed);
+        } else {
+            TrafficLog::ChunkHeader header{ TrafficLog::kChunkMagic, staging.count, staging.used, staging.firstNs, staging.lastNs };
+            std::memcpy(staging.data.get(), &header, sizeof(header));
+            std::memcpy(map_ + offset, staging.data.get(), staging.used);
+            recorded_.fetch_add(staging.count, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(indexMutex_);
+            pendingIndex_.push_back(TrafficLog::IndexEntry{ offset, staging.firstNs });
+            if (pendingIndex_.size() >= config_.indexEveryChunks) WriteIndexLocked();
+        }
+        staging.used = sizeof(TrafficLog::ChunkHeader);
+        staging.count = 0;
+    }
+
+    Public TrafficCapture()
+        : id_(InstanceCounter().fetch_add(1, std::memory_order_relaxed)), open_(false), fd_(-1), map_(nullptr),
+          mapSize_(0), writeOffset_(0), committedEnd_(0), startNs_(0), sampleThreshold_(UINT32_MAX), lastIndexOffset_(0),
+          recorded_(0), sampledOut_(0), dropped_(0) {}
+
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    Public ~TrafficCapture() {
+        Close();
+    }
+
+    /**
+     * Create (or truncate) the log file and start accepting records
+     * @return false if the file cannot be created or mapped, or on platforms without mmap
+     */
+    Public Bool Open(CStdString& path, const TrafficCaptureConfig& config = TrafficCaptureConfig()) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (open_.load(std::memory_order_acquire)) return false;
+        config_ = config;
+        if (config_.stagingBytes < 4096) config_.stagingBytes = 4096;
+        if (config_.indexEveryChunks == 0) config_.indexEveryChunks = 1;
+        const double rate = config_.sampleRate < 0.0 ? 0.0 : (config_.sampleRate > 1.0 ? 1.0 : config_.sampleRate);
+        sampleThreshold_ = rate >= 1.0 ? UINT32_MAX : static_cast<std::uint32_t>(rate * 4294967295.0);
+
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) return false;
+        mapSize_ = config_.maxFileBytes;
+        void* map = MAP_FAILED;
+        if (::ftruncate(fd_, static_cast<off_t>(mapSize_)) == 0) {
+            map = ::mmap(nullptr, static_cast<Size>(mapSize_), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        }
+        if (map == MAP_FAILED) {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        map_ = static_cast<char*>(map);
+
+        TrafficLog::FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, TrafficLog::kFileMagic, sizeof(header.magic));
+        header.version = TrafficLog::kVersion;
+        header.headerSize = sizeof(header);
+        header.startWallNs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        std::memcpy(map_, &header, sizeof(header));
+
+        startNs_ = MonotonicNs();
+        writeOffset_.store(sizeof(header), std::memory_order_relaxed);
+        committedEnd_.store(sizeof(header), std::memory_order_relaxed);
+        lastIndexOffset_ = 0;
+        pendingIndex_.clear();
+        recorded_.store(0, std::memory_order_relaxed);
+        sampledOut_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        open_.store(true, std::memory_order_release);
+        return true;
+#else
+        (void)path; (void)config;
+        return false;
+#endif
+    }
+
+    /**
+     * Record one request as received (raw bytes from the socket)
+     * Safe to call from any number of threads; returns quickly when sampled out or not open.
+     * @return true if the request was staged for the log
+     */
+    Public Bool Record(const char* data, Size length) {
+        if (!open_.load(std::memory_order_acquire)) return false;
+        if (!Sampled()) {
+            sampledOut_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const std::uint64_t now = MonotonicNs() - startNs_;
+        const Size recordSize = sizeof(TrafficLog::RecordHeader) + TrafficLog::Align8(length);
+        if (length > UINT32_MAX || sizeof(TrafficLog::ChunkHeader) + recordSize > config_.stagingBytes) {
+            // Larger than a staging buffer: not captured
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Staging& staging = LocalStaging();
+        Acquire(staging.busy);
+        if (!open_.load(std::memory_order_relaxed)) {
+            staging.busy.store(false, std::memory_order_release);
+            return false;
+        }
+        if (sizeof(TrafficLog::ChunkHeader) + recordSize > staging.capacity) {
+            // Buffer created under a smaller stagingBytes by an earlier Open()
+            staging.busy.store(false, std::memory_order_release);
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (staging.used + recordSize > staging.capacity ||
+            (config_.flushIntervalMs != 0 && staging.count != 0 &&
+             now - staging.startedNs > static_cast<std::uint64_t>(config_.flushIntervalMs) * 1000000ULL)) {
+            FlushStaging(staging);
+        }
+        if (staging.count == 0) {
+            staging.firstNs = now;
+            staging.startedNs = now;
+        }
+        TrafficLog::RecordHeader header{ static_cast<std::uint32_t>(length), 0, now };
+        char* out = staging.data.get() + staging.used;
+        std::memcpy(out, &header, sizeof(header));
+        std::memcpy(out + sizeof(header), data, length);
+        std::memset(out + sizeof(header) + length, 0, TrafficLog::Align8(length) - length);
+        staging.used += recordSize;
+        staging.lastNs = now;
+        ++staging.count;
+        staging.busy.store(false, std::memory_order_release);
+        return true;
+    }
+
+    Public Bool Record(CStdString& raw) {
+        return Record(raw.data(), raw.length());
+    }
+
+    /**
+     * Write all staged records of all threads to the log
+     */
+    Public Void Flush() {
+        if (!open_.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        for (auto& staging : stagings_) {
+            Acquire(staging->busy);
+            FlushStaging(*staging);
+            staging->busy.store(false, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Flush, write the final index and header, and truncate the file to its contents
+     * Stop feeding records first (e.g. SetTrafficCapture(nullptr)); later Record() calls return false.
+     */
+    Public Void Close() {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (!open_.exchange(false, std::memory_order_acq_rel)) return;
+        {
+            // Acquiring each buffer also waits out Record() calls that passed the open check
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            for (auto& staging : stagings_) {
+                Acquire(staging->busy);
+                FlushStaging(*staging);
+                staging->busy.store(false, std::memory_order_release);
+            }
+        }
+        std::uint64_t dataEnd = 0;
+        {
+            std::lock_guard<std::mutex> lock(indexMutex_);
+            WriteIndexLocked();
+            dataEnd = committedEnd_.load(std::memory_order_relaxed);
+            TrafficLog::FileHeader header;
+            std::memcpy(&header, map_, sizeof(header));
+            header.dataEnd = dataEnd;
+            header.lastIndexOffset = lastIndexOffset_;
+            header.recordCount = recorded_.load(std::memory_order_relaxed);
+            std::memcpy(map_, &header, sizeof(header));
+        }
+        ::msync(map_, static_cast<Size>(dataEnd), MS_SYNC);
+        ::munmap(map_, static_cast<Size>(mapSize_));
+        map_ = nullptr;
+        if (::ftruncate(fd_, static_cast<off_t>(dataEnd)) != 0) {
+            // The file keeps its sparse tail; readers stop at FileHeader::dataEnd
+        }
+        ::close(fd_);
+        fd_ = -1;
+#endif
+    }
+
+    Public Bool IsOpen() const {
+        return open_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Requests written to the log (staged records count once flushed)
+     */
+    Public ULong GetRecordedCount() const { return recorded_.load(std::memory_order_relaxed); }
+    Public ULong GetSampledOutCount() const { return sampledOut_.load(std::memory_order_relaxed); }
+
+    /**
+     * Requests lost because the log was full or a request was larger than a staging buffer
+     */
+    Public ULong GetDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+};
+
+#endif // TRAFFICCAPTURE_H
@@ -0,0 +1,341 @@
+#ifndef TRAFFICREPLAY_H
+#define TRAFFICREPLAY_H
+
+#include <StandardDefines.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include "HttpClient.h"
+#include "HttpResponseParser.h"
+#include "LatencyHistogram.h"
+#include "TrafficCapture.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * One captured request: raw bytes (a view into the mapped log) and its arrival time
+ */
+class TrafficRecord {
+    Public std::uint64_t timestampNs;
+    Public std::string_view request;
+};
+
+/**
+ * Read-only, memory-mapped view of a log written by TrafficCapture
+ * Records are views into the mapping and stay valid until Close() or destruction.
+ */
+class TrafficLogReader {
+
+    Private int fd_;
+    Private const char* map_;
+    Private Size mapSize_;
+    Private std::uint64_t dataEnd_;
+    Private std::uint64_t startWallNs_;
+
+    Public TrafficLogReader() : fd_(-1), map_(nullptr), mapSize_(0), dataEnd_(0), startWallNs_(0) {}
+
+    TrafficLogReader(const TrafficLogReader&) = delete;
+    TrafficLogReader& operator=(const TrafficLogReader&) = delete;
+
+    Public ~TrafficLogReader() {
+        Close();
+    }
+
+    /**
+     * Map a capture log
+     * A log whose capture was not closed (dataEnd 0) is read up to the first incomplete block.
+     * @return false if the file cannot be mapped or is not a capture log
+     */
+    Public Bool Open(CStdString& path) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        Close();
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) return false;
+        struct stat info;
+        if (::fstat(fd_, &info) != 0 || static_cast<Size>(info.st_size) < sizeof(TrafficLog::FileHeader)) {
+            Close();
+            return false;
+        }
+        mapSize_ = static_cast<Size>(info.st_size);
+        void* map = ::mmap(nullptr, mapSize_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            mapSize_ = 0;
+            Close();
+            return false;
+        }
+        map_ = static_cast<const char*>(map);
+        ::madvise(map, mapSize_, MADV_SEQUENTIAL);
+
+        TrafficLog::FileHeader header;
+        std::memcpy(&header, map_, sizeof(header));
+        if (std::memcmp(header.magic, TrafficLog::kFileMagic, sizeof(header.magic)) != 0 ||
+            header.version != TrafficLog::kVersion || header.headerSize != sizeof(header)) {
+            Close();
+            return false;
+        }
+        dataEnd_ = header.dataEnd != 0 && header.dataEnd <= mapSize_ ? header.dataEnd : mapSize_;
+        startWallNs_ = header.startWallNs;
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    Public Void Close() {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (map_ != nullptr) ::munmap(const_cast<char*>(map_), mapSize_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+        map_ = nullptr;
+        mapSize_ = 0;
+        fd_ = -1;
+        dataEnd_ = 0;
+    }
+
+    /**
+     * Wall-clock capture start in ns since the Unix epoch
+     */
+    Public std::uint64_t GetStartWallNs() const {
+        return startWallNs_;
+    }
+
+    /**
+     * Call fn(const TrafficRecord&) for every record, in file order (chunk by chunk)
+     * @return Number of records visited
+     */
+    template<typename Fn>
+    ULong ForEach(Fn&& fn) const {
+        ULong visited = 0;
+        std::uint64_t offset = sizeof(TrafficLog::FileHeader);
+        while (offset + sizeof(TrafficLog::ChunkHeader) <= dataEnd_) {
+            TrafficLog::ChunkHeader chunk;
+            std::memcpy(&chunk, map_ + offset, sizeof(chunk));
+            if ((chunk.magic != TrafficLog::kChunkMagic && chunk.magic != TrafficLog::kIndexMagic) ||
+                chunk.length < sizeof(chunk) || offset + chunk.length > dataEnd_) {
+                break;
+            }
+            if (chunk.magic == TrafficLog::kChunkMagic) {
+                std::uint64_t position = offset + sizeof(chunk);
+                for (std::uint32_t index = 0; index < chunk.recordCount; ++index) {
+                    TrafficLog::RecordHeader header;
+                    if (position + sizeof(header) > offset + chunk.length) break;
+                    std::memcpy(&header, map_ + position, sizeof(header));
+                    position += sizeof(header);
+                    if (position + header.length > offset + chunk.length) break;
+                    fn(TrafficRecord{ header.timestampNs, std::string_view(map_ + position, header.length) });
+                    position += TrafficLog::Align8(header.length);
+                    ++visited;
+                }
+            }
+            offset += chunk.length;
+        }
+        return visited;
+    }
+
+    /**
+     * All records ordered by arrival time (chunks from different threads interleave in the file)
+     */
+    Public StdVector<TrafficRecord> LoadSorted() const {
+        StdVector<TrafficRecord> records;
+        ForEach([&records](const TrafficRecord& record) { records.push_back(record); });
+        std::stable_sort(records.begin(), records.end(), [](const TrafficRecord& a, const TrafficRecord& b) {
+            return a.timestampNs < b.timestampNs;
+        });
+        return records;
+    }
+};
+
+/**
+ * How TrafficReplay paces requests
+ */
+enum class ReplayTiming {
+    Original,   // Send each request at its captured offset from the first one
+    Scaled,     // Original timing divided by TrafficReplayConfig::speed (2.0 = twice as fast)
+    MaxRate     // Send each request as soon as the connection's previous response arrived
+};
+
+/**
+ * Settings for TrafficReplay::Run()
+ */
+class TrafficReplayConfig {
+    Public StdString host = "127.0.0.1";
+    Public UInt port = 8080;
+    Public ReplayTiming timing = ReplayTiming::MaxRate;
+    Public double speed = 1.0;
+
+    /**
+     * Concurrent keep-alive connections; records are dealt to them round-robin
+     */
+    Public UInt connections = 8;
+
+    /**
+     * Stop after this many records (0 = all)
+     */
+    Public ULong maxRequests = 0;
+
+    /**
+     * Per-request deadline for sending and receiving the response
+     */
+    Public int timeoutMs = 5000;
+};
+
+/**
+ * Outcome of a replay run
+ */
+class TrafficReplayReport {
+    Public ULong sent = 0;
+    Public ULong completed = 0;
+    Public ULong failed = 0;
+    Public ULong reconnects = 0;
+    Public double elapsedSeconds = 0.0;
+    // Microseconds from the scheduled send time to the complete response
+    Public LatencyHistogram latency;
+
+    Public double GetThroughput() const {
+        return elapsedSeconds > 0.0 ? static_cast<double>(completed) / elapsedSeconds : 0.0;
+    }
+
+    /**
+     * One-line summary, e.g. for printing after a benchmark run
+     */
+    Public StdString ToString() const {
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "%lu requests, %lu failed in %.2f s: %.0f req/s, latency us p50 %lu p90 %lu p99 %lu p99.9 %lu max %lu",
+                      static_cast<unsigned long>(completed), static_cast<unsigned long>(failed), elapsedSeconds, GetThroughput(),
+                      static_cast<unsigned long>(latency.GetPercentile(50.0)), static_cast<unsigned long>(latency.GetPercentile(90.0)),
+                      static_cast<unsigned long>(latency.GetPercentile(99.0)), static_cast<unsigned long>(latency.GetPercentile(99.9)),
+                      static_cast<unsigned long>(latency.GetMax()));
+        return StdString(line);
+    }
+};
+
+/**
+ * Replays captured traffic against a server to benchmark parser and handler changes with
+ * production request shapes
+ * Requests are sent byte-for-byte as captured over keep-alive connections, one outstanding request
+ * per connection. With Original/Scaled timing, latency is measured from each request's scheduled
+ * send time, so a stalled server is charged for the requests queued behind it (no coordinated
+ * omission).
+ *
+ *   TrafficLogReader log;
+ *   log.Open("/var/tmp/traffic.slcap");
+ *   TrafficReplayConfig config;
+ *   config.port = 8080;
+ *   TrafficReplayReport report;
+ *   TrafficReplay::Run(log.LoadSorted(), config, report);
+ *   printf("%s\n", report.ToString().c_str());
+ */
+class TrafficReplay {
+
+    Private Static Bool IsHeadRequest(std::string_view request) {
+        return request.compare(0, 5, "HEAD ") == 0;
+    }
+
+    /**
+     * Replay every connections-th record starting at first
+     */
+    Private Static Void RunConnection(const StdVector<TrafficRecord>& records, Size first, Size count, const TrafficReplayConfig& config,
+                                      std::chrono::steady_clock::time_point start, std::uint64_t baseNs, TrafficReplayReport& report,
+                                      std::atomic<ULong>& sent, std::atomic<ULong>& completed, std::atomic<ULong>& failed,
+                                      std::atomic<ULong>& reconnects) {
+        UpstreamPool pool(config.host, config.port, 1);
+        HttpResponseParser parser(false);
+        const double divisor = config.timing == ReplayTiming::Scaled && config.speed > 0.0 ? config.speed : 1.0;
+        int fd = -1;
+
+        for (Size index = first; index < count; index += config.connections) {
+            const TrafficRecord& record = records[index];
+            std::chrono::steady_clock::time_point scheduled = std::chrono::steady_clock::now();
+            if (config.timing != ReplayTiming::MaxRate) {
+                const double offsetNs = static_cast<double>(record.timestampNs - baseNs) / divisor;
+                scheduled = start + std::chrono::nanoseconds(static_cast<long long>(offsetNs));
+                std::this_thread::sleep_until(scheduled);
+            }
+            if (fd < 0) {
+                Bool reused = false;
+                fd = pool.Acquire(config.timeoutMs, reused);
+                if (fd < 0) {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                reconnects.fetch_add(1, std::memory_order_relaxed);
+            }
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.timeoutMs);
+            sent.fetch_add(1, std::memory_order_relaxed);
+            Bool received = false;
+            parser.Reset();
+            parser.ExpectNoBody(IsHeadRequest(record.request));
+            Bool ok = HttpClient::WriteAll(fd, record.request.data(), record.request.length(), deadline) &&
+                      HttpClient::ReadResponse(fd, parser, deadline, received);
+            // Skip interim responses (100 Continue)
+            while (ok && parser.GetStatusCode() >= 100 && parser.GetStatusCode() < 200 && parser.GetStatusCode() != 101) {
+                parser.TakeResponse(StdString());
+                parser.ExpectNoBody(IsHeadRequest(record.request));
+                ok = HttpClient::ReadResponse(fd, parser, deadline, received);
+            }
+            if (!ok) {
+                failed.fetch_add(1, std::memory_order_relaxed);
+                pool.Release(fd, false);
+                fd = -1;
+                continue;
+            }
+            report.latency.Record(static_cast<ULong>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - scheduled).count()));
+            completed.fetch_add(1, std::memory_order_relaxed);
+            if (!parser.IsKeepAlive() || parser.HasBufferedData()) {
+                pool.Release(fd, false);
+                fd = -1;
+            }
+        }
+        if (fd >= 0) pool.Release(fd, false);
+    }
+
+    /**
+     * Replay records (ordered by timestamp, e.g. TrafficLogReader::LoadSorted()) and wait for the result
+     * @param report Filled with counts, elapsed time and the latency histogram
+     */
+    Public Static Void Run(const StdVector<TrafficRecord>& records, TrafficReplayConfig config, TrafficReplayReport& report) {
+        if (config.connections == 0) config.connections = 1;
+        const Size count = config.maxRequests != 0 && config.maxRequests < records.size()
+            ? static_cast<Size>(config.maxRequests) : records.size();
+        report.latency.Reset();
+        if (count == 0) return;
+
+        std::atomic<ULong> sent(0);
+        std::atomic<ULong> completed(0);
+        std::atomic<ULong> failed(0);
+        std::atomic<ULong> reconnects(0);
+        const std::uint64_t baseNs = records.front().timestampNs;
+        const auto start = std::chrono::steady_clock::now();
+        StdVector<std::thread> workers;
+        const UInt workerCount = static_cast<UInt>(std::min<Size>(config.connections, count));
+        for (UInt worker = 0; worker < workerCount; ++worker) {
+            workers.emplace_back([&, worker]() {
+                RunConnection(records, worker, count, config, start, baseNs, report, sent, completed, failed, reconnects);
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+
+        report.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report.sent = sent.load();
+        report.completed = completed.load();
+        report.failed = failed.load();
+        // The first connection of each worker is not a reconnect
+        const ULong connects = reconnects.load();
+        report.reconnects = connects > workerCount ? connects - workerCount : 0;
+    }
+};
+
+#endif // TRAFFICREPLAY_H
@@ -0,0 +1,272 @@
+#ifndef ZEROCOPYSENDER_H
+#define ZEROCOPYSENDER_H
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include "SocketPlatform.h"
+
+#ifdef SERVERLIB_POSIX_SOCKETS
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#ifdef SERVERLIB_LINUX
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#endif
+
+/**
+ * Send path for large responses using MSG_ZEROCOPY
+ * Payloads at or above the threshold are sent without copying into the socket buffer; the kernel
+ * pins the pages, so the sender keeps each buffer alive until the completion for every sendmsg()
+ * that referenced it has been read from the socket's error queue. Smaller payloads (where page
+ * pinning and the completion round trip cost more than the copy) and platforms without
+ * MSG_ZEROCOPY use a plain send(). One sender per connection; not thread-safe.
+ *
+ *   ZeroCopySender sender(fd);
+ *   sender.SendAll(std::make_shared<const StdString>(response->ToHttpString()));
+ *   ...
+ *   sender.ReapCompletions();   // from the reactor when the fd reports POLLERR / EPOLLERR
+ */
+class ZeroCopySender {
+
+    /**
+     * Default size from which zero-copy is used; below roughly this size the copy is cheaper on loopback
+     */
+    Public Static constexpr Size kDefaultThreshold = 64 * 1024;
+
+    /**
+     * A buffer referenced by one or more zero-copy sendmsg() calls
+     */
+    Private class PendingBuffer {
+        Public std::shared_ptr<const StdString> buffer;
+        Public std::uint32_t firstId = 0;
+        Public std::uint32_t lastId = 0;
+        Public std::uint32_t outstanding = 0;
+        // Set once SendAll() has issued its last sendmsg() for the buffer
+        Public Bool sealed = false;
+    };
+
+    Private int fd_;
+    Private Size threshold_;
+    Private Bool zeroCopyEnabled_;
+    // The kernel numbers every successful MSG_ZEROCOPY sendmsg() on the socket from 0
+    Private std::uint32_t nextId_;
+    Private std::deque<PendingBuffer> pending_;
+    Private ULong zeroCopySends_;
+    Private ULong copiedSends_;
+    Private ULong kernelCopiedCompletions_;
+
+    /**
+     * Apply the completion range [first, last] of sendmsg() ids and drop buffers with nothing outstanding
+     */
+    Private Size Complete(std::uint32_t first, std::uint32_t last) {
+        Size released = 0;
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            // Ids increase monotonically; compare as offsets from first so wrap-around is harmless
+            const std::uint32_t span = last - first;
+            const std::uint32_t low = it->firstId - first <= span ? it->firstId : first;
+            const std::uint32_t high = it->lastId - first <= span ? it->lastId : last;
+            const Bool overlaps = (it->firstId - first <= span) || (it->lastId - first <= span) ||
+                                  (first - it->firstId <= it->lastId - it->firstId);
+            if (overlaps) {
+                const std::uint32_t covered = high - low + 1;
+                it->outstanding = covered >= it->outstanding ? 0 : it->outstanding - covered;
+            }
+            if (it->sealed && it->outstanding == 0) {
+                it = pending_.erase(it);
+                ++released;
+            } else {
+                ++it;
+            }
+        }
+        return released;
+    }
+
+    Private Void WaitWritable(int timeoutMs) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        pollfd entry{};
+        entry.fd = fd_;
+        entry.events = POLLOUT;
+        ::poll(&entry, 1, timeoutMs);
+#else
+        (void)timeoutMs;
+#endif
+    }
+
+    /**
+     * @param fd Connected TCP socket (the sender does not take ownership)
+     * @param threshold Minimum payload size for zero-copy; 0 disables zero-copy
+     */
+    Public explicit ZeroCopySender(int fd, Size threshold = kDefaultThreshold)
+        : fd_(fd), threshold_(threshold), zeroCopyEnabled_(false), nextId_(0),
+          zeroCopySends_(0), copiedSends_(0), kernelCopiedCompletions_(0) {
+#if defined(SERVERLIB_LINUX) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+        if (threshold_ > 0) {
+            const int enable = 1;
+            zeroCopyEnabled_ = ::setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+        }
+#endif
+    }
+
+    /**
+     * Waits briefly for outstanding completions so buffers are not modified while still queued
+     */
+    Public ~ZeroCopySender() {
+        WaitForCompletions(1000);
+    }
+
+    ZeroCopySender(const ZeroCopySender&) = delete;
+    ZeroCopySender& operator=(const ZeroCopySender&) = delete;
+
+    /**
+     * True if the socket accepted SO_ZEROCOPY
+     */
+    Public Bool IsZeroCopyEnabled() const {
+        return zeroCopyEnabled_;
+    }
+
+    /**
+     * Send the whole buffer, waiting for socket space when the socket is non-blocking
+     * @param buffer Payload; kept alive until the kernel no longer references it
+     * @return true if every byte was handed to the kernel
+     */
+    Public Bool SendAll(std::shared_ptr<const StdString> buffer) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        if (buffer == nullptr) return false;
+        const Bool zeroCopy = zeroCopyEnabled_ && buffer->size() >= threshold_;
+        if (zeroCopy) {
+            // Registered before sending so completions reaped mid-send are applied to it
+            PendingBuffer entry;
+            entry.buffer = buffer;
+            entry.firstId = nextId_;
+            pending_.push_back(std::move(entry));
+        }
+
+        Size offset = 0;
+        while (offset < buffer->size()) {
+            int flags = 0;
+#ifdef MSG_NOSIGNAL
+            flags |= MSG_NOSIGNAL;
+#endif
+#if defined(SERVERLIB_LINUX) && defined(MSG_ZEROCOPY)
+            if (zeroCopy) flags |= MSG_ZEROCOPY;
+#endif
+            const ssize_t sent = ::send(fd_, buffer->data() + offset, buffer->size() - offset, flags);
+            if (sent > 0) {
+                offset += static_cast<Size>(sent);
+                if (zeroCopy) {
+                    // The unsealed entry is always the last one
+                    pending_.back().lastId = nextId_++;
+                    ++pending_.back().outstanding;
+                }
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+                // ENOBUFS: the socket's optmem limit for pinned pages is exhausted until completions are read
+                ReapCompletions();
+                WaitWritable(1000);
+                continue;
+            }
+            break;
+        }
+
+        if (zeroCopy) {
+            ++zeroCopySends_;
+            pending_.back().sealed = true;
+            if (pending_.back().outstanding == 0) pending_.pop_back();
+        } else {
+            ++copiedSends_;
+        }
+        ReapCompletions();
+        return offset == buffer->size();
+#else
+        (void)buffer;
+        return false;
+#endif
+    }
+
+    /**
+     * Read zero-copy completions from the error queue and release buffers no longer referenced
+     * Non-blocking; call whenever the socket reports an error event.
+     * @return Number of buffers released
+     */
+    Public Size ReapCompletions() {
+        Size released = 0;
+#if defined(SERVERLIB_LINUX) && defined(MSG_ZEROCOPY)
+        while (!pending_.empty()) {
+            alignas(cmsghdr) char control[128];
+            msghdr message{};
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            if (::recvmsg(fd_, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) break;
+
+            for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr;
+                 header = CMSG_NXTHDR(&message, header)) {
+                const Bool isRecvErr = (header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR) ||
+                                       (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR);
+                if (!isRecvErr) continue;
+                const sock_extended_err* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(header));
+                if (error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+                if (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                    // The kernel fell back to copying (e.g. loopback); zero-copy bought nothing here
+                    ++kernelCopiedCompletions_;
+                }
+                released += Complete(error->ee_info, error->ee_data);
+            }
+        }
+#endif
+        return released;
+    }
+
+    /**
+     * Block until every pending buffer has completed or the timeout expires
+     * @return true if no buffers remain pending
+     */
+    Public Bool WaitForCompletions(CUInt timeoutMs) {
+#ifdef SERVERLIB_POSIX_SOCKETS
+        UInt waited = 0;
+        while (!pending_.empty() && waited < timeoutMs) {
+            ReapCompletions();
+            if (pending_.empty()) break;
+            pollfd entry{};
+            entry.fd = fd_;
+            entry.events = 0;
+            // The error queue is signalled with POLLERR, which poll() always reports
+            if (::poll(&entry, 1, 10) < 0 && errno != EINTR) break;
+            waited += 10;
+        }
+#else
+        (void)timeoutMs;
+#endif
+        return pending_.empty();
+    }
+
+    /**
+     * Buffers still referenced by the kernel
+     */
+    Public Size GetPendingCount() const {
+        return pending_.size();
+    }
+
+    Public ULong GetZeroCopySendCount() const {
+        return zeroCopySends_;
+    }
+
+    Public ULong GetCopiedSendCount() const {
+        return copiedSends_;
+    }
+
+    /**
+     * Completions the kernel reported as copied anyway (SO_EE_CODE_ZEROCOPY_COPIED)
+     */
+    Public ULong GetKernelCopiedCount() const {
+        return kernelCopiedCompletions_;
+    }
+};
+
+#endif // ZEROCOPYSENDER_H
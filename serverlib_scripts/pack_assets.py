@@ -0,0 +1,365 @@
+"""
+Script to pack a directory of static assets into a single bundle served by AssetBundle.h.
+
+Every file gets a pre-serialized response head (status line, Content-Type, Content-Length,
+ETag, Cache-Control) and, for compressible types, a gzip variant when it is smaller. Paths are
+indexed with a minimal perfect hash so a lookup costs two hashes and one path comparison.
+
+Usage:
+    python pack_assets.py <asset_dir> <output.bin> [--c-header assets.h --symbol kWebAssets]
+                          [--cache-control "no-cache"] [--gzip-min-bytes 256] [--no-gzip]
+
+The bundle layout (little-endian) is documented in AssetBundle.h (namespace AssetBundleFormat);
+keep both in sync.
+"""
+
+import argparse
+import gzip
+import hashlib
+import mimetypes
+import os
+import struct
+import sys
+from pathlib import Path
+
+
+FILE_MAGIC = b"SLASSET1"
+FORMAT_VERSION = 1
+FILE_HEADER_SIZE = 64
+ENTRY_SIZE = 96
+BODY_ALIGNMENT = 8
+GZIP_FLAG = 1
+
+MASK64 = 0xFFFFFFFFFFFFFFFF
+MULTIPLIER1 = 0x87C37B91114253D5
+MULTIPLIER2 = 0x4CF5AD432745937F
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".htm": "text/html; charset=utf-8",
+    ".css": "text/css; charset=utf-8",
+    ".js": "application/javascript; charset=utf-8",
+    ".mjs": "application/javascript; charset=utf-8",
+    ".json": "application/json",
+    ".map": "application/json",
+    ".txt": "text/plain; charset=utf-8",
+    ".xml": "application/xml",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".jpeg": "image/jpeg",
+    ".gif": "image/gif",
+    ".webp": "image/webp",
+    ".ico": "image/x-icon",
+    ".woff": "font/woff",
+    ".woff2": "font/woff2",
+    ".ttf": "font/ttf",
+    ".wasm": "application/wasm",
+    ".webmanifest": "application/manifest+json",
+}
+
+COMPRESSIBLE_PREFIXES = ("text/", "application/javascript", "application/json", "application/xml",
+                         "application/manifest+json", "application/wasm", "image/svg+xml", "font/ttf")
+
+
+def rotate_left(value, bits):
+    """
+    Rotate a 64-bit value left.
+    """
+    return ((value << bits) | (value >> (64 - bits))) & MASK64
+
+
+def fmix64(value):
+    """
+    MurmurHash3 finalizer, as FastHash::Mix.
+    """
+    value ^= value >> 33
+    value = (value * 0xFF51AFD7ED558CCD) & MASK64
+    value ^= value >> 33
+    value = (value * 0xC4CEB9FE1A85EC53) & MASK64
+    value ^= value >> 33
+    return value
+
+
+def fast_hash64(data, seed=0):
+    """
+    Port of FastHash::Hash64; the bundle index depends on both producing identical values.
+
+    Args:
+        data: bytes to hash
+        seed: 64-bit seed
+
+    Returns:
+        int: 64-bit hash
+    """
+    length = len(data)
+    value = (seed ^ (length * MULTIPLIER1)) & MASK64
+    offset = 0
+    while offset + 8 <= length:
+        word = int.from_bytes(data[offset:offset + 8], "little")
+        word = (word * MULTIPLIER1) & MASK64
+        word = rotate_left(word, 31)
+        word = (word * MULTIPLIER2) & MASK64
+        value ^= word
+        value = (rotate_left(value, 27) * 5 + 0x52DCE729) & MASK64
+        offset += 8
+    if offset < length:
+        tail = int.from_bytes(data[offset:], "little")
+        tail = (tail * MULTIPLIER2) & MASK64
+        tail = rotate_left(tail, 33)
+        tail = (tail * MULTIPLIER1) & MASK64
+        value ^= tail
+    return fmix64(value)
+
+
+def build_perfect_hash(keys):
+    """
+    Build a minimal perfect hash (hash-and-displace) over the keys.
+
+    A key's bucket is fast_hash64(key) % bucket_count. A negative displacement d places the
+    bucket's single key in slot -d - 1; otherwise its keys go to fast_hash64(key, d) % len(keys).
+
+    Args:
+        keys: list of distinct bytes
+
+    Returns:
+        tuple: (displacements, slots) where slots[i] is the index into keys stored at slot i
+    """
+    count = len(keys)
+    bucket_count = max(1, count // 2)
+    buckets = [[] for _ in range(bucket_count)]
+    for index, key in enumerate(keys):
+        buckets[fast_hash64(key) % bucket_count].append(index)
+
+    displacements = [0] * bucket_count
+    slots = [None] * count
+    order = sorted(range(bucket_count), key=lambda bucket: len(buckets[bucket]), reverse=True)
+
+    # Buckets with several keys: search for a seed that places them all in free slots
+    position = 0
+    while position < len(order) and len(buckets[order[position]]) > 1:
+        bucket = order[position]
+        seed = 1
+        while True:
+            placed = [fast_hash64(keys[index], seed) % count for index in buckets[bucket]]
+            if len(set(placed)) == len(placed) and all(slots[slot] is None for slot in placed):
+                break
+            seed += 1
+            if seed >= 0x7FFFFFFF:
+                raise RuntimeError("could not build a perfect hash")
+        for index, slot in zip(buckets[bucket], placed):
+            slots[slot] = index
+        displacements[bucket] = seed
+        position += 1
+
+    # Single-key buckets take the remaining slots directly
+    free = [slot for slot in range(count) if slots[slot] is None]
+    for bucket in order[position:]:
+        if not buckets[bucket]:
+            break
+        slot = free.pop()
+        slots[slot] = buckets[bucket][0]
+        displacements[bucket] = -slot - 1
+    return displacements, slots
+
+
+def get_content_type(path):
+    """
+    Content-Type for a file name, defaulting to application/octet-stream.
+    """
+    suffix = path.suffix.lower()
+    if suffix in CONTENT_TYPES:
+        return CONTENT_TYPES[suffix]
+    guessed, _ = mimetypes.guess_type(path.name)
+    return guessed or "application/octet-stream"
+
+
+def build_heads(content_type, length, etag, cache_control, gzip_variant, has_gzip):
+    """
+    Serialize the 200 and 304 response heads for one variant.
+
+    Returns:
+        tuple: (head bytes, 304 head bytes, offset of the ETag value within the head)
+    """
+    lines = ["HTTP/1.1 200 OK", "Content-Type: " + content_type, "Content-Length: " + str(length)]
+    if gzip_variant:
+        lines.append("Content-Encoding: gzip")
+    etag_line = len("\r\n".join(lines)) + 2 + len("ETag: ")
+    lines.append("ETag: " + etag)
+    if cache_control:
+        lines.append("Cache-Control: " + cache_control)
+    if has_gzip:
+        lines.append("Vary: Accept-Encoding")
+    head = ("\r\n".join(lines) + "\r\n\r\n").encode("ascii")
+
+    not_modified = ["HTTP/1.1 304 Not Modified", "ETag: " + etag]
+    if cache_control:
+        not_modified.append("Cache-Control: " + cache_control)
+    if has_gzip:
+        not_modified.append("Vary: Accept-Encoding")
+    return head, ("\r\n".join(not_modified) + "\r\n\r\n").encode("ascii"), etag_line
+
+
+def collect_assets(asset_dir, cache_control, use_gzip, gzip_min_bytes):
+    """
+    Read every file under asset_dir and prepare its variants.
+
+    Returns:
+        list: dicts with "paths" (URL paths, including the directory alias for index.html) and
+              "variants" (list of (head, not_modified, etag_offset, etag, body), identity first)
+    """
+    root = Path(asset_dir)
+    assets = []
+    for file_path in sorted(path for path in root.rglob("*") if path.is_file()):
+        relative = file_path.relative_to(root).as_posix()
+        body = file_path.read_bytes()
+        content_type = get_content_type(file_path)
+        digest = hashlib.sha1(body).hexdigest()[:20]
+
+        compressed = None
+        if use_gzip and len(body) >= gzip_min_bytes and content_type.startswith(COMPRESSIBLE_PREFIXES):
+            candidate = gzip.compress(body, compresslevel=9, mtime=0)
+            # Not worth a second variant unless it saves at least 10%
+            if len(candidate) * 10 < len(body) * 9:
+                compressed = candidate
+
+        variants = []
+        etag = '"' + digest + '"'
+        head, not_modified, etag_offset = build_heads(content_type, len(body), etag, cache_control, False,
+                                                      compressed is not None)
+        variants.append((head, not_modified, etag_offset, etag, body))
+        if compressed is not None:
+            etag = '"' + digest + '-gz"'
+            head, not_modified, etag_offset = build_heads(content_type, len(compressed), etag, cache_control,
+                                                          True, True)
+            variants.append((head, not_modified, etag_offset, etag, compressed))
+
+        paths = ["/" + relative]
+        if file_path.name == "index.html":
+            directory = relative[:-len("index.html")]
+            paths.append("/" + directory)
+        assets.append({"paths": paths, "variants": variants})
+    return assets
+
+
+def align(value, alignment):
+    """
+    Round value up to a multiple of alignment.
+    """
+    return (value + alignment - 1) // alignment * alignment
+
+
+def write_bundle(assets):
+    """
+    Serialize the bundle.
+
+    Returns:
+        bytes: bundle contents
+    """
+    keys = []
+    owners = []
+    for asset_index, asset in enumerate(assets):
+        for path in asset["paths"]:
+            keys.append(path.encode("utf-8"))
+            owners.append(asset_index)
+    if len(set(keys)) != len(keys):
+        raise RuntimeError("duplicate asset paths")
+
+    displacements, slots = build_perfect_hash(keys) if keys else ([0], [])
+    bucket_offset = FILE_HEADER_SIZE
+    entry_offset = align(bucket_offset + 4 * len(displacements), 8)
+    string_offset = entry_offset + ENTRY_SIZE * len(keys)
+
+    # Strings region: paths, then per-variant head + 304 head; bodies follow, aligned
+    strings = bytearray()
+    path_offsets = []
+    for key in keys:
+        path_offsets.append(string_offset + len(strings))
+        strings += key
+    head_offsets = []
+    for asset in assets:
+        offsets = []
+        for head, not_modified, _, _, _ in asset["variants"]:
+            offsets.append(string_offset + len(strings))
+            strings += head + not_modified
+        head_offsets.append(offsets)
+
+    body_start = align(string_offset + len(strings), BODY_ALIGNMENT)
+    bodies = bytearray()
+    body_offsets = []
+    for asset in assets:
+        offsets = []
+        for _, _, _, _, body in asset["variants"]:
+            bodies += b"\0" * (align(len(bodies), BODY_ALIGNMENT) - len(bodies))
+            offsets.append(body_start + len(bodies))
+            bodies += body
+        body_offsets.append(offsets)
+    file_size = body_start + len(bodies)
+
+    out = bytearray()
+    out += struct.pack("<8sIIIIQQQ16s", FILE_MAGIC, FORMAT_VERSION, FILE_HEADER_SIZE, len(keys), len(displacements),
+                       bucket_offset, entry_offset, file_size, b"\0" * 16)
+    out += struct.pack("<%di" % len(displacements), *displacements)
+    out += b"\0" * (entry_offset - len(out))
+    for slot in range(len(keys)):
+        key_index = slots[slot]
+        asset_index = owners[key_index]
+        variants = assets[asset_index]["variants"]
+        flags = GZIP_FLAG if len(variants) > 1 else 0
+        out += struct.pack("<QII", path_offsets[key_index], len(keys[key_index]), flags)
+        for variant in range(2):
+            if variant < len(variants):
+                head, not_modified, etag_offset, etag, body = variants[variant]
+                out += struct.pack("<QIIQQII", head_offsets[asset_index][variant], len(head), len(not_modified),
+                                   body_offsets[asset_index][variant], len(body), etag_offset, len(etag))
+            else:
+                out += b"\0" * 40
+    out += strings
+    out += b"\0" * (body_start - len(out))
+    out += bodies
+    return bytes(out)
+
+
+def write_c_header(bundle, header_path, symbol):
+    """
+    Emit the bundle as a C array for targets without a filesystem (see AssetBundle::Attach).
+    """
+    guard = Path(header_path).name.upper().replace(".", "_").replace("-", "_")
+    lines = ["#ifndef " + guard, "#define " + guard, "", "#include <cstddef>", "",
+             "// Generated by serverlib_scripts/pack_assets.py; do not edit",
+             "alignas(8) static const unsigned char " + symbol + "[] = {"]
+    for offset in range(0, len(bundle), 16):
+        lines.append("    " + ", ".join("0x%02X" % byte for byte in bundle[offset:offset + 16]) + ",")
+    lines += ["};", "static const std::size_t " + symbol + "Size = sizeof(" + symbol + ");", "", "#endif // " + guard, ""]
+    Path(header_path).write_text("\n".join(lines))
+
+
+def main():
+    """
+    Command-line entry point.
+    """
+    parser = argparse.ArgumentParser(description="Pack static assets into an AssetBundle archive")
+    parser.add_argument("asset_dir", help="directory whose files are served, relative paths become URL paths")
+    parser.add_argument("output", help="bundle file to write")
+    parser.add_argument("--cache-control", default="no-cache", help='Cache-Control value ("" to omit)')
+    parser.add_argument("--gzip-min-bytes", type=int, default=256, help="smallest file to precompress")
+    parser.add_argument("--no-gzip", action="store_true", help="do not add gzip variants")
+    parser.add_argument("--c-header", help="also write the bundle as a C array to this header")
+    parser.add_argument("--symbol", default="kAssetBundle", help="array name for --c-header")
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.asset_dir):
+        print("Error: " + args.asset_dir + " is not a directory", file=sys.stderr)
+        return 1
+    assets = collect_assets(args.asset_dir, args.cache_control, not args.no_gzip, args.gzip_min_bytes)
+    bundle = write_bundle(assets)
+    Path(args.output).write_bytes(bundle)
+    if args.c_header:
+        write_c_header(bundle, args.c_header, args.symbol)
+    gzipped = sum(1 for asset in assets if len(asset["variants"]) > 1)
+    print("Packed %d files (%d with gzip) into %s, %d bytes" % (len(assets), gzipped, args.output, len(bundle)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())